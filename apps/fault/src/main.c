@@ -24,8 +24,8 @@
 #define NOPS ""
 #include <arch/fault.h>
 
-#define N_FAULTER_ARGS 3
-#define N_HANDLER_ARGS 5
+#define N_FAULTER_ARGS 4
+#define N_HANDLER_ARGS 6
 
 static char faulter_args[N_FAULTER_ARGS][WORD_STRING_SIZE];
 static char *faulter_argv[N_FAULTER_ARGS];
@@ -52,7 +52,7 @@ static inline void fault(void)
 
 static void parse_handler_args(int argc, char **argv,
                                seL4_CPtr *ep, volatile ccnt_t **start, fault_results_t **results,
-                               seL4_CPtr *done_ep, seL4_CPtr *reply)
+                               seL4_CPtr *done_ep, seL4_CPtr *reply, void **cold_cache)
 {
     assert(argc == N_HANDLER_ARGS);
     *ep = atol(argv[0]);
@@ -60,6 +60,15 @@ static void parse_handler_args(int argc, char **argv,
     *results = (fault_results_t *) atol(argv[2]);
     *done_ep = atol(argv[3]);
     *reply = atol(argv[4]);
+    *cold_cache = (void *) atol(argv[5]);
+}
+
+/* pollute the caches before a measurement, if this is a cold cache run */
+static inline void pollute_caches(void *cold_cache)
+{
+    if (cold_cache != NULL) {
+        benchmark_pollute_caches(cold_cache);
+    }
 }
 
 static inline void fault_handler_done(seL4_CPtr ep, seL4_Word ip, seL4_CPtr done_ep, seL4_CPtr reply)
@@ -94,8 +103,10 @@ static void measure_fault_fn(int argc, char **argv)
     assert(argc == N_FAULTER_ARGS);
     volatile ccnt_t *start = (volatile ccnt_t *) atol(argv[0]);
     seL4_CPtr done_ep = atol(argv[2]);
+    void *cold_cache = (void *) atol(argv[3]);
 
     for (int i = 0; i < N_RUNS + 1; i++) {
+        pollute_caches(cold_cache);
         /* record time */
         SEL4BENCH_READ_CCNT(*start);
         fault();
@@ -109,8 +120,9 @@ static void measure_fault_handler_fn(int argc, char **argv)
     volatile ccnt_t *start;
     ccnt_t end;
     fault_results_t *results;
+    void *cold_cache;
 
-    parse_handler_args(argc, argv, &ep, &start, &results, &done_ep, &reply);
+    parse_handler_args(argc, argv, &ep, &start, &results, &done_ep, &reply, &cold_cache);
 
     seL4_Word ip = fault_handler_start(ep, done_ep, reply);
     for (int i = 0; i < N_RUNS; i++) {
@@ -118,7 +130,7 @@ static void measure_fault_handler_fn(int argc, char **argv)
         DO_REAL_REPLY_RECV_1(ep, ip, reply);
 
         SEL4BENCH_READ_CCNT(end);
-        results->fault[i] = end - *start;
+        results->fault[cache_state(cold_cache)][i] = end - *start;
     }
     fault_handler_done(ep, ip, done_ep, reply);
 }
@@ -130,6 +142,7 @@ static void measure_fault_reply_fn(int argc, char **argv)
     volatile ccnt_t *start = (volatile ccnt_t *) atol(argv[0]);
     fault_results_t *results = (fault_results_t *) atol(argv[1]);
     seL4_CPtr done_ep = atol(argv[2]);
+    void *cold_cache = (void *) atol(argv[3]);
 
     /* handle 1 fault first to make sure start is set */
     fault();
@@ -137,7 +150,7 @@ static void measure_fault_reply_fn(int argc, char **argv)
         fault();
         ccnt_t end;
         SEL4BENCH_READ_CCNT(end);
-        results->fault_reply[i] = end - *start;
+        results->fault_reply[cache_state(cold_cache)][i] = end - *start;
     }
     seL4_Signal(done_ep);
 }
@@ -147,12 +160,14 @@ static void measure_fault_reply_handler_fn(int argc, char **argv)
     seL4_CPtr ep, done_ep, reply;
     volatile ccnt_t *start;
     fault_results_t *results;
+    void *cold_cache;
 
-    parse_handler_args(argc, argv, &ep, &start, &results, &done_ep, &reply);
+    parse_handler_args(argc, argv, &ep, &start, &results, &done_ep, &reply, &cold_cache);
 
     seL4_Word ip = fault_handler_start(ep, done_ep, reply);
     for (int i = 0; i <= N_RUNS; i++) {
         ip += UD_INSTRUCTION_SIZE;
+        pollute_caches(cold_cache);
         /* record time */
         SEL4BENCH_READ_CCNT(*start);
         /* wait for fault */
@@ -167,13 +182,15 @@ static void measure_fault_roundtrip_fn(int argc, char **argv)
     assert(argc == N_FAULTER_ARGS);
     fault_results_t *results = (fault_results_t *) atol(argv[1]);
     seL4_CPtr done_ep = atol(argv[2]);
+    void *cold_cache = (void *) atol(argv[3]);
 
     for (int i = 0; i < N_RUNS + 1; i++) {
         ccnt_t start, end;
+        pollute_caches(cold_cache);
         SEL4BENCH_READ_CCNT(start);
         fault();
         SEL4BENCH_READ_CCNT(end);
-        results->round_trip[i] = end - start;
+        results->round_trip[cache_state(cold_cache)][i] = end - start;
     }
     seL4_Signal(done_ep);
 }
@@ -183,8 +200,9 @@ static void measure_fault_roundtrip_handler_fn(int argc, char **argv)
     seL4_CPtr ep, done_ep, reply;
     UNUSED volatile ccnt_t *start;
     fault_results_t *results;
+    UNUSED void *cold_cache;
 
-    parse_handler_args(argc, argv, &ep, &start, &results, &done_ep, &reply);
+    parse_handler_args(argc, argv, &ep, &start, &results, &done_ep, &reply, &cold_cache);
 
     seL4_Word ip = fault_handler_start(ep, done_ep, reply);
     for (int i = 0; i < N_RUNS; i++) {
@@ -246,23 +264,30 @@ static void run_fault_benchmark(env_t *env, fault_results_t *results)
     ccnt_t start = 0;
 
     benchmark_configure_thread(env, fault_endpoint.cptr, seL4_MinPrio + 1, "faulter", &faulter);
-    sel4utils_create_word_args(faulter_args, faulter_argv, N_FAULTER_ARGS, (seL4_Word) &start,
-                               (seL4_Word) results, done_ep.cptr);
 
     /* create fault handler */
     benchmark_configure_thread(env, seL4_CapNull, seL4_MinPrio, "fault handler", &fault_handler);
-    sel4utils_create_word_args(handler_args, handler_argv, N_HANDLER_ARGS,
-                               fault_endpoint.cptr, (seL4_Word) &start,
-                               (seL4_Word) results, done_ep.cptr, fault_handler.reply.cptr);
 
-    /* benchmark fault */
-    run_benchmark(measure_fault_fn, measure_fault_handler_fn, done_ep.cptr);
+    /* with CONFIG_COLD_CACHE, run each benchmark again, polluting the caches before each fault */
+    void *cold_cache = benchmark_init_cold_cache(env);
 
-    /* benchmark reply */
-    run_benchmark(measure_fault_reply_fn, measure_fault_reply_handler_fn, done_ep.cptr);
+    for (int cache = CACHE_HOT; cache < N_CACHE_STATES; cache++) {
+        seL4_Word cold = cache == CACHE_COLD ? (seL4_Word) cold_cache : 0;
+        sel4utils_create_word_args(faulter_args, faulter_argv, N_FAULTER_ARGS, (seL4_Word) &start,
+                                   (seL4_Word) results, done_ep.cptr, cold);
+        sel4utils_create_word_args(handler_args, handler_argv, N_HANDLER_ARGS,
+                                   fault_endpoint.cptr, (seL4_Word) &start,
+                                   (seL4_Word) results, done_ep.cptr, fault_handler.reply.cptr, cold);
 
-    /* benchmark round_trip */
-    run_benchmark(measure_fault_roundtrip_fn, measure_fault_roundtrip_handler_fn, done_ep.cptr);
+        /* benchmark fault */
+        run_benchmark(measure_fault_fn, measure_fault_handler_fn, done_ep.cptr);
+
+        /* benchmark reply */
+        run_benchmark(measure_fault_reply_fn, measure_fault_reply_handler_fn, done_ep.cptr);
+
+        /* benchmark round_trip */
+        run_benchmark(measure_fault_roundtrip_fn, measure_fault_roundtrip_handler_fn, done_ep.cptr);
+    }
 }
 
 void measure_overhead(fault_results_t *results)
@@ -17,6 +17,7 @@
 #include <sel4benchipc/gen_config.h>
 #include <allocman/vka.h>
 #include <allocman/bootstrap.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stddef.h>
@@ -36,7 +37,28 @@
 
 #include <arch/ipc.h>
 
-#define NUM_ARGS 3
+/* endpoint, result ring, reply, command ring (only with CONFIG_IPC_WORKER_POOL), cold cache buffer
+ * (only for cold runs), message length (only for the length sweep functions), for the cap
+ * transfer functions, the number of caps, the badged endpoint to send and the cap to transfer (or
+ * for a server, the slot to receive it in), and for the contention functions, the number of
+ * messages for the server to handle and a notification for clients to wait on when done */
+#define NUM_ARGS (9 + 2 * RESULT_RING_NUM_ARGS)
+#define REPLY_ARG (1 + RESULT_RING_NUM_ARGS)
+#define COMMAND_ARG (2 + RESULT_RING_NUM_ARGS)
+#define COLD_CACHE_ARG (2 + 2 * RESULT_RING_NUM_ARGS)
+#define LENGTH_ARG (3 + 2 * RESULT_RING_NUM_ARGS)
+#define EXTRA_CAPS_ARG (4 + 2 * RESULT_RING_NUM_ARGS)
+#define BADGED_EP_ARG (5 + 2 * RESULT_RING_NUM_ARGS)
+#define CAP_ARG (6 + 2 * RESULT_RING_NUM_ARGS)
+#define MESSAGES_ARG (7 + 2 * RESULT_RING_NUM_ARGS)
+#define PARK_ARG (8 + 2 * RESULT_RING_NUM_ARGS)
+
+/* threads of the contention benchmark, its clients and server */
+#define CONTENTION_THREADS (config_set(CONFIG_IPC_CONTENTION) ? IPC_CONTENTION_MAX_CLIENTS + 1 : 0)
+
+/* badge of the endpoint caps that are unwrapped by the cap transfer benchmarks */
+#define UNWRAPPED_BADGE 0x61
+
 /* Ensure that enough warmups are performed to prevent the FPU from
  * being restored. */
 #ifdef CONFIG_FPU_MAX_RESTORES_SINCE_SWITCH
@@ -46,7 +68,7 @@
 #endif
 #define OVERHEAD_RETRIES 4
 
-#ifndef CONFIG_CYCLE_COUNT
+#if defined(CONFIG_GENERIC_COUNTER) || defined(CONFIG_PLATFORM_COUNTER)
 
 #define GENERIC_COUNTER_MASK (BIT(0))
 #undef READ_COUNTER_BEFORE
@@ -55,10 +77,76 @@
 #define READ_COUNTER_AFTER(x) sel4bench_get_counters(GENERIC_COUNTER_MASK, &x)
 #endif
 
+#ifdef CONFIG_ALL_COUNTERS
+/* Read the enabled chunk of generic counters along with the cycle counter. The generic counters
+ * are read outside of the cycle counter reads, so the cycle counts match a cycle count only run. */
+#define DECLARE_COUNTERS \
+    counter_bitfield_t counter_mask = all_counters_mask(); \
+    ccnt_t start_counters[SEL4BENCH_NUM_GENERIC_EVENTS] UNUSED; \
+    ccnt_t end_counters[SEL4BENCH_NUM_GENERIC_EVENTS] UNUSED;
+#define READ_BEFORE(x) do { \
+    sel4bench_get_counters(counter_mask, x##_counters); \
+    READ_COUNTER_BEFORE(x); \
+} while (0)
+#define READ_AFTER(x) do { \
+    READ_COUNTER_AFTER(x); \
+    sel4bench_get_counters(counter_mask, x##_counters); \
+} while (0)
+/* push a timestamp, followed by the counters read with it */
+#define PUSH_RESULT(ring, x) do { \
+    result_ring_push(ring, x); \
+    for (int c = 0; c < num_used_counters(); c++) { \
+        result_ring_push(ring, x##_counters[c]); \
+    } \
+    result_ring_flush(ring); \
+} while (0)
+#else
+#define DECLARE_COUNTERS
+#define READ_BEFORE(x) READ_COUNTER_BEFORE(x)
+#define READ_AFTER(x) READ_COUNTER_AFTER(x)
+#define PUSH_RESULT(ring, x) do { \
+    result_ring_push(ring, x); \
+    result_ring_flush(ring); \
+} while (0)
+#endif
+
+/* with CONFIG_IPC_WORKER_POOL, the thread returns to its command loop when it is done, otherwise it
+ * blocks so it doesn't run off the stack, until it is suspended */
+#ifdef CONFIG_IPC_WORKER_POOL
+#define PARK(ep)
+#else
+#define PARK(ep) api_wait(ep, NULL)
+#endif
+
+/* with CONFIG_COLD_CACHE, pollute the caches before the last iteration, which is the one measured,
+ * of a cold run */
+#ifdef CONFIG_COLD_CACHE
+#define POLLUTE_CACHES(i, cold_cache) do { \
+    if ((i) == WARMUPS - 1 && (cold_cache) != NULL) { \
+        benchmark_pollute_caches(cold_cache); \
+    } \
+} while (0)
+#else
+#define POLLUTE_CACHES(i, cold_cache)
+#endif
+
 typedef struct helper_thread {
     sel4utils_process_t process;
     seL4_CPtr ep;
-    seL4_CPtr result_ep;
+    /* results from this thread */
+    result_ring_t ring;
+    seL4_Word ring_args[RESULT_RING_NUM_ARGS];
+    /* with CONFIG_IPC_WORKER_POOL, the helper functions for this thread to run */
+    result_ring_t commands;
+    seL4_Word command_args[RESULT_RING_NUM_ARGS];
+    /* with CONFIG_COLD_CACHE, the cold cache buffer as seen by this thread */
+    void *cold_cache;
+    /* for a client, a badged copy of ep and a cap to transfer, and for a server, the empty slot to
+     * receive it in */
+    seL4_CPtr badged_ep;
+    seL4_CPtr cap;
+    /* for a contention client, a notification to wait on once it is done */
+    seL4_CPtr park;
     char *argv[NUM_ARGS];
     char argv_strings[NUM_ARGS][WORD_STRING_SIZE];
 } helper_thread_t;
@@ -73,6 +161,17 @@ size_t __arch_write(char *data, int count)
     return benchmark_write(data, count);
 }
 
+/* number of generic counters read at once, no more than there are events to count */
+static inline int num_used_counters(void)
+{
+    return MIN(sel4bench_get_num_counters(), SEL4BENCH_NUM_GENERIC_EVENTS);
+}
+
+static inline counter_bitfield_t all_counters_mask(void)
+{
+    return BIT(num_used_counters()) - 1;
+}
+
 static void timing_init(void)
 {
     sel4bench_init();
@@ -95,6 +194,10 @@ void timing_destroy(void)
     sel4bench_stop_counters(GENERIC_COUNTER_MASK);
     sel4bench_destroy();
 #endif
+#ifdef CONFIG_ALL_COUNTERS
+    sel4bench_stop_counters(all_counters_mask());
+    sel4bench_destroy();
+#endif
 }
 
 static inline void dummy_seL4_Send(seL4_CPtr ep, seL4_MessageInfo_t tag)
@@ -124,6 +227,24 @@ seL4_Word ipc_replyrecv_10_func2(int argc, char *argv[]);
 seL4_Word ipc_replyrecv_10_func(int argc, char *argv[]);
 seL4_Word ipc_send_func(int argc, char *argv[]);
 seL4_Word ipc_recv_func(int argc, char *argv[]);
+seL4_Word ipc_call_n_func(int argc, char *argv[]);
+seL4_Word ipc_call_n_func2(int argc, char *argv[]);
+seL4_Word ipc_replyrecv_n_func2(int argc, char *argv[]);
+seL4_Word ipc_replyrecv_n_func(int argc, char *argv[]);
+seL4_Word ipc_call_unwrap_func2(int argc, char *argv[]);
+seL4_Word ipc_call_transfer_func2(int argc, char *argv[]);
+seL4_Word ipc_replyrecv_caps_func2(int argc, char *argv[]);
+seL4_Word ipc_contention_client_func(int argc, char *argv[]);
+seL4_Word ipc_contention_server_func(int argc, char *argv[]);
+seL4_Word ipc_nbsend_func(int argc, char *argv[]);
+seL4_Word ipc_poll_send_func(int argc, char *argv[]);
+seL4_Word ipc_poll_func(int argc, char *argv[]);
+#ifdef CONFIG_KERNEL_RT
+seL4_Word ipc_nbsendwait_func(int argc, char *argv[]);
+seL4_Word ipc_nbsendwait_func2(int argc, char *argv[]);
+seL4_Word ipc_nbsendrecv_func2(int argc, char *argv[]);
+seL4_Word ipc_nbsendrecv_func(int argc, char *argv[]);
+#endif
 
 static helper_func_t bench_funcs[] = {
     ipc_call_func,
@@ -135,27 +256,48 @@ static helper_func_t bench_funcs[] = {
     ipc_replyrecv_10_func2,
     ipc_replyrecv_10_func,
     ipc_send_func,
-    ipc_recv_func
+    ipc_recv_func,
+    ipc_call_n_func,
+    ipc_call_n_func2,
+    ipc_replyrecv_n_func2,
+    ipc_replyrecv_n_func,
+    ipc_call_unwrap_func2,
+    ipc_call_transfer_func2,
+    ipc_replyrecv_caps_func2,
+    ipc_contention_client_func,
+    ipc_contention_server_func,
+    ipc_nbsend_func,
+    ipc_poll_send_func,
+    ipc_poll_func,
+#ifdef CONFIG_KERNEL_RT
+    ipc_nbsendwait_func,
+    ipc_nbsendwait_func2,
+    ipc_nbsendrecv_func2,
+    ipc_nbsendrecv_func
+#endif
 };
 
 #define IPC_CALL_FUNC(name, bench_func, send_func, call_func, send_start_end, length) \
     seL4_Word name(int argc, char *argv[]) { \
     uint32_t i; \
     ccnt_t start UNUSED, end UNUSED; \
+    DECLARE_COUNTERS \
     seL4_CPtr ep = atoi(argv[0]);\
-    seL4_CPtr result_ep = atoi(argv[1]);\
+    result_ring_t ring = result_ring_from_args(&argv[1]);\
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);\
     seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, length); \
     call_func(ep, tag); \
     COMPILER_MEMORY_FENCE(); \
     for (i = 0; i < WARMUPS; i++) { \
-        READ_COUNTER_BEFORE(start); \
+        POLLUTE_CACHES(i, cold_cache); \
+        READ_BEFORE(start); \
         bench_func(ep, tag); \
-        READ_COUNTER_AFTER(end); \
+        READ_AFTER(end); \
     } \
     COMPILER_MEMORY_FENCE(); \
-    send_result(result_ep, send_start_end); \
+    PUSH_RESULT(&ring, send_start_end); \
     send_func(ep, tag); \
-    api_wait(ep, NULL);/* block so we don't run off the stack */ \
+    PARK(ep); \
     return 0; \
 }
 
@@ -163,15 +305,20 @@ IPC_CALL_FUNC(ipc_call_func, DO_REAL_CALL, seL4_Send, dummy_seL4_Call, end, 0)
 IPC_CALL_FUNC(ipc_call_func2, DO_REAL_CALL, dummy_seL4_Send, seL4_Call, start, 0)
 IPC_CALL_FUNC(ipc_call_10_func, DO_REAL_CALL_10, seL4_Send, dummy_seL4_Call, end, 10)
 IPC_CALL_FUNC(ipc_call_10_func2, DO_REAL_CALL_10, dummy_seL4_Send, seL4_Call, start, 10)
+/* the 10 word versions clobber every message register, so they do for any length */
+IPC_CALL_FUNC(ipc_call_n_func, DO_REAL_CALL_10, seL4_Send, dummy_seL4_Call, end, atol(argv[LENGTH_ARG]))
+IPC_CALL_FUNC(ipc_call_n_func2, DO_REAL_CALL_10, dummy_seL4_Send, seL4_Call, start, atol(argv[LENGTH_ARG]))
 
 #define IPC_REPLY_RECV_FUNC(name, bench_func, reply_func, recv_func, send_start_end, length) \
 seL4_Word name(int argc, char *argv[]) { \
     uint32_t i; \
     ccnt_t start UNUSED, end UNUSED; \
+    DECLARE_COUNTERS \
     seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, length); \
     seL4_CPtr ep = atoi(argv[0]);\
-    seL4_CPtr result_ep = atoi(argv[1]);\
-    seL4_CPtr reply = atoi(argv[2]);\
+    result_ring_t ring = result_ring_from_args(&argv[1]);\
+    seL4_CPtr reply = atoi(argv[REPLY_ARG]);\
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);\
     if (config_set(CONFIG_KERNEL_RT)) {\
         api_nbsend_recv(ep, tag, ep, NULL, reply);\
     } else {\
@@ -179,14 +326,15 @@ seL4_Word name(int argc, char *argv[]) { \
     }\
     COMPILER_MEMORY_FENCE(); \
     for (i = 0; i < WARMUPS; i++) { \
-        READ_COUNTER_BEFORE(start); \
+        POLLUTE_CACHES(i, cold_cache); \
+        READ_BEFORE(start); \
         bench_func(ep, tag, reply); \
-        READ_COUNTER_AFTER(end); \
+        READ_AFTER(end); \
     } \
     COMPILER_MEMORY_FENCE(); \
     reply_func(reply, tag); \
-    send_result(result_ep, send_start_end); \
-    api_wait(ep, NULL); /* block so we don't run off the stack */ \
+    PUSH_RESULT(&ring, send_start_end); \
+    PARK(ep); \
     return 0; \
 }
 
@@ -194,25 +342,173 @@ IPC_REPLY_RECV_FUNC(ipc_replyrecv_func2, DO_REAL_REPLY_RECV, api_reply, api_recv
 IPC_REPLY_RECV_FUNC(ipc_replyrecv_func, DO_REAL_REPLY_RECV, dummy_seL4_Reply, api_recv, start, 0)
 IPC_REPLY_RECV_FUNC(ipc_replyrecv_10_func2, DO_REAL_REPLY_RECV_10, api_reply, api_recv, end, 10)
 IPC_REPLY_RECV_FUNC(ipc_replyrecv_10_func, DO_REAL_REPLY_RECV_10, dummy_seL4_Reply, api_recv, start, 10)
+IPC_REPLY_RECV_FUNC(ipc_replyrecv_n_func2, DO_REAL_REPLY_RECV_10, api_reply, api_recv, end, atol(argv[LENGTH_ARG]))
+IPC_REPLY_RECV_FUNC(ipc_replyrecv_n_func, DO_REAL_REPLY_RECV_10, dummy_seL4_Reply, api_recv, start, atol(argv[LENGTH_ARG]))
+
+/* Call with the extra caps of the benchmark, which are copies of a badged endpoint cap to be
+ * unwrapped, except for the first if transfer is set, which is derived into the server's slot */
+static inline seL4_Word ipc_call_caps(char *argv[], bool transfer)
+{
+    uint32_t i;
+    ccnt_t start UNUSED, end UNUSED;
+    DECLARE_COUNTERS
+    seL4_CPtr ep = atoi(argv[0]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);
+    seL4_Word extra_caps = atol(argv[EXTRA_CAPS_ARG]);
+    seL4_CPtr badged_ep = atol(argv[BADGED_EP_ARG]);
+    seL4_CPtr cap = atol(argv[CAP_ARG]);
+
+    for (seL4_Word c = 0; c < extra_caps; c++) {
+        seL4_SetCap(c, c == 0 && transfer ? cap : badged_ep);
+    }
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, extra_caps, 0);
+    seL4_Call(ep, tag);
+    COMPILER_MEMORY_FENCE();
+    for (i = 0; i < WARMUPS; i++) {
+        /* on x86 the call overwrites tag with the reply's, which has no caps */
+        tag = seL4_MessageInfo_new(0, 0, extra_caps, 0);
+        POLLUTE_CACHES(i, cold_cache);
+        READ_BEFORE(start);
+        DO_REAL_CALL(ep, tag);
+        READ_AFTER(end);
+    }
+    COMPILER_MEMORY_FENCE();
+    PUSH_RESULT(&ring, start);
+    PARK(ep);
+    return 0;
+}
+
+seL4_Word ipc_call_unwrap_func2(int argc, char *argv[])
+{
+    return ipc_call_caps(argv, false);
+}
+
+seL4_Word ipc_call_transfer_func2(int argc, char *argv[])
+{
+    return ipc_call_caps(argv, true);
+}
+
+/* ReplyRecv for calls with caps. The slot that caps are received in is emptied after each call,
+ * outside of the timed region, so that the next cap can be transferred into it */
+seL4_Word ipc_replyrecv_caps_func2(int argc, char *argv[])
+{
+    uint32_t i;
+    ccnt_t start UNUSED, end UNUSED;
+    DECLARE_COUNTERS
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0);
+    seL4_CPtr ep = atoi(argv[0]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    seL4_CPtr reply = atoi(argv[REPLY_ARG]);
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);
+    seL4_CPtr slot = atol(argv[CAP_ARG]);
+
+    seL4_SetCapReceivePath(SEL4UTILS_CNODE_SLOT, slot, seL4_WordBits);
+    if (config_set(CONFIG_KERNEL_RT)) {
+        api_nbsend_recv(ep, tag, ep, NULL, reply);
+    } else {
+        api_recv(ep, NULL, reply);
+    }
+    COMPILER_MEMORY_FENCE();
+    for (i = 0; i < WARMUPS; i++) {
+        seL4_CNode_Delete(SEL4UTILS_CNODE_SLOT, slot, seL4_WordBits);
+        /* on x86 the receive overwrites tag with the call's, including its caps */
+        tag = seL4_MessageInfo_new(0, 0, 0, 0);
+        POLLUTE_CACHES(i, cold_cache);
+        READ_BEFORE(start);
+        DO_REAL_REPLY_RECV(ep, tag, reply);
+        READ_AFTER(end);
+    }
+    COMPILER_MEMORY_FENCE();
+    seL4_CNode_Delete(SEL4UTILS_CNODE_SLOT, slot, seL4_WordBits);
+    api_reply(reply, seL4_MessageInfo_new(0, 0, 0, 0));
+    PUSH_RESULT(&ring, end);
+    PARK(ep);
+    return 0;
+}
+
+/* Call the server repeatedly, and push the round trip time of the call in the middle, which
+ * includes the time spent queued behind the other clients. The clients take turns at the end of
+ * the queue, so they finish one after another, and only calls before then see every other client
+ * queued. A client waits on a notification when it is done, rather than on the endpoint, where it
+ * would take calls meant for the server */
+seL4_Word ipc_contention_client_func(int argc, char *argv[])
+{
+    uint32_t i;
+    ccnt_t start UNUSED, end UNUSED;
+    ccnt_t latency = 0;
+    seL4_CPtr ep = atoi(argv[0]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    seL4_CPtr park = atol(argv[PARK_ARG]);
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0);
+
+    COMPILER_MEMORY_FENCE();
+    for (i = 0; i < WARMUPS; i++) {
+        READ_COUNTER_BEFORE(start);
+        DO_REAL_CALL(ep, tag);
+        READ_COUNTER_AFTER(end);
+        if (i == WARMUPS / 2) {
+            latency = end - start;
+        }
+    }
+    COMPILER_MEMORY_FENCE();
+    result_ring_push(&ring, latency);
+    result_ring_flush(&ring);
+    seL4_Wait(park, NULL);
+    return 0;
+}
+
+/* Handle the given number of calls, and push the time from receiving the first to receiving the
+ * last */
+seL4_Word ipc_contention_server_func(int argc, char *argv[])
+{
+    ccnt_t start UNUSED, end UNUSED;
+    seL4_CPtr ep = atoi(argv[0]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    seL4_CPtr reply = atoi(argv[REPLY_ARG]);
+    seL4_Word messages = atol(argv[MESSAGES_ARG]);
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0);
+
+    if (config_set(CONFIG_KERNEL_RT)) {
+        api_nbsend_recv(ep, tag, ep, NULL, reply);
+    } else {
+        api_recv(ep, NULL, reply);
+    }
+    COMPILER_MEMORY_FENCE();
+    READ_COUNTER_BEFORE(start);
+    for (seL4_Word i = 1; i < messages; i++) {
+        DO_REAL_REPLY_RECV(ep, tag, reply);
+    }
+    READ_COUNTER_AFTER(end);
+    COMPILER_MEMORY_FENCE();
+    api_reply(reply, tag);
+    result_ring_push(&ring, end - start);
+    result_ring_flush(&ring);
+    api_wait(ep, NULL);
+    return 0;
+}
 
 seL4_Word
 ipc_recv_func(int argc, char *argv[])
 {
     uint32_t i;
     ccnt_t start UNUSED, end UNUSED;
+    DECLARE_COUNTERS
     seL4_CPtr ep = atoi(argv[0]);
-    seL4_CPtr result_ep = atoi(argv[1]);
-    UNUSED seL4_CPtr reply = atoi(argv[2]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    UNUSED seL4_CPtr reply = atoi(argv[REPLY_ARG]);
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);
 
     COMPILER_MEMORY_FENCE();
     for (i = 0; i < WARMUPS; i++) {
-        READ_COUNTER_BEFORE(start);
+        POLLUTE_CACHES(i, cold_cache);
+        READ_BEFORE(start);
         DO_REAL_RECV(ep, reply);
-        READ_COUNTER_AFTER(end);
+        READ_AFTER(end);
     }
     COMPILER_MEMORY_FENCE();
     DO_REAL_RECV(ep, reply);
-    send_result(result_ep, end);
+    PUSH_RESULT(&ring, end);
     return 0;
 }
 
@@ -220,21 +516,205 @@ seL4_Word ipc_send_func(int argc, char *argv[])
 {
     uint32_t i;
     ccnt_t start UNUSED, end UNUSED;
+    DECLARE_COUNTERS
     seL4_CPtr ep = atoi(argv[0]);
-    seL4_CPtr result_ep = atoi(argv[1]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);
     seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0);
     COMPILER_MEMORY_FENCE();
     for (i = 0; i < WARMUPS; i++) {
-        READ_COUNTER_BEFORE(start);
+        POLLUTE_CACHES(i, cold_cache);
+        READ_BEFORE(start);
         DO_REAL_SEND(ep, tag);
-        READ_COUNTER_AFTER(end);
+        READ_AFTER(end);
     }
     COMPILER_MEMORY_FENCE();
-    send_result(result_ep, start);
+    PUSH_RESULT(&ring, start);
     DO_REAL_SEND(ep, tag);
     return 0;
 }
 
+/* NBSend to a server with a higher priority, which runs as soon as it gets each message, so it is
+ * always back waiting in Recv before the next is sent and none are dropped */
+seL4_Word ipc_nbsend_func(int argc, char *argv[])
+{
+    uint32_t i;
+    ccnt_t start UNUSED, end UNUSED;
+    DECLARE_COUNTERS
+    seL4_CPtr ep = atoi(argv[0]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0);
+    COMPILER_MEMORY_FENCE();
+    for (i = 0; i < WARMUPS; i++) {
+        POLLUTE_CACHES(i, cold_cache);
+        READ_BEFORE(start);
+        DO_REAL_NBSEND(ep, tag);
+        READ_AFTER(end);
+    }
+    COMPILER_MEMORY_FENCE();
+    PUSH_RESULT(&ring, start);
+    DO_REAL_NBSEND(ep, tag);
+    return 0;
+}
+
+/* Send to a server with a lower priority, which polls for each message. The client is queued on
+ * the endpoint before each poll, and runs again as soon as the poll takes its message. The first
+ * message is taken by a blocking Recv, so that the server cannot poll before the client is queued */
+seL4_Word ipc_poll_send_func(int argc, char *argv[])
+{
+    uint32_t i;
+    ccnt_t start UNUSED, end UNUSED;
+    DECLARE_COUNTERS
+    seL4_CPtr ep = atoi(argv[0]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0);
+    seL4_Send(ep, tag);
+    COMPILER_MEMORY_FENCE();
+    for (i = 0; i < WARMUPS; i++) {
+        POLLUTE_CACHES(i, cold_cache);
+        READ_BEFORE(start);
+        DO_REAL_SEND(ep, tag);
+        READ_AFTER(end);
+    }
+    COMPILER_MEMORY_FENCE();
+    PUSH_RESULT(&ring, end);
+    PARK(ep);
+    return 0;
+}
+
+seL4_Word ipc_poll_func(int argc, char *argv[])
+{
+    uint32_t i;
+    ccnt_t start UNUSED, end UNUSED;
+    DECLARE_COUNTERS
+    seL4_CPtr ep = atoi(argv[0]);
+    result_ring_t ring = result_ring_from_args(&argv[1]);
+    seL4_CPtr reply = atoi(argv[REPLY_ARG]);
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);
+
+    api_recv(ep, NULL, reply);
+    COMPILER_MEMORY_FENCE();
+    for (i = 0; i < WARMUPS; i++) {
+        POLLUTE_CACHES(i, cold_cache);
+        READ_BEFORE(start);
+        DO_REAL_POLL(ep);
+        READ_AFTER(end);
+    }
+    COMPILER_MEMORY_FENCE();
+    PUSH_RESULT(&ring, start);
+    PARK(ep);
+    return 0;
+}
+
+#ifdef CONFIG_KERNEL_RT
+/*
+ * The client and server ping pong messages with NBSendWait and NBSendRecv, each sending to the
+ * other, which is always waiting by then, and waiting for the next message. As with the first Call
+ * and the last reply of the Call and ReplyRecv benchmarks, the client sends a message before the
+ * timed region of the NBSendWait benchmark, and the server after it, and for the NBSendRecv
+ * benchmark the client sends one after it.
+ */
+#define IPC_NBSEND_WAIT_FUNC(name, first_func, last_func, send_start_end) \
+seL4_Word name(int argc, char *argv[]) { \
+    uint32_t i; \
+    ccnt_t start UNUSED, end UNUSED; \
+    DECLARE_COUNTERS \
+    seL4_CPtr ep = atoi(argv[0]);\
+    result_ring_t ring = result_ring_from_args(&argv[1]);\
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);\
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0); \
+    first_func(ep, tag); \
+    COMPILER_MEMORY_FENCE(); \
+    for (i = 0; i < WARMUPS; i++) { \
+        POLLUTE_CACHES(i, cold_cache); \
+        READ_BEFORE(start); \
+        DO_REAL_NBSEND_WAIT(ep, tag); \
+        READ_AFTER(end); \
+    } \
+    COMPILER_MEMORY_FENCE(); \
+    PUSH_RESULT(&ring, send_start_end); \
+    last_func(ep, tag); \
+    PARK(ep); \
+    return 0; \
+}
+
+IPC_NBSEND_WAIT_FUNC(ipc_nbsendwait_func, dummy_seL4_Send, DO_REAL_NBSEND, end)
+IPC_NBSEND_WAIT_FUNC(ipc_nbsendwait_func2, DO_REAL_NBSEND_WAIT, dummy_seL4_Send, start)
+
+/* the first NBSendRecv tells the benchmark that the server is initialised */
+#define IPC_NBSEND_RECV_FUNC(name, last_func, send_start_end) \
+seL4_Word name(int argc, char *argv[]) { \
+    uint32_t i; \
+    ccnt_t start UNUSED, end UNUSED; \
+    DECLARE_COUNTERS \
+    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0); \
+    seL4_CPtr ep = atoi(argv[0]);\
+    result_ring_t ring = result_ring_from_args(&argv[1]);\
+    seL4_CPtr reply = atoi(argv[REPLY_ARG]);\
+    UNUSED void *cold_cache = (void *) atol(argv[COLD_CACHE_ARG]);\
+    api_nbsend_recv(ep, tag, ep, NULL, reply);\
+    COMPILER_MEMORY_FENCE(); \
+    for (i = 0; i < WARMUPS; i++) { \
+        POLLUTE_CACHES(i, cold_cache); \
+        READ_BEFORE(start); \
+        DO_REAL_NBSEND_RECV(ep, tag, reply); \
+        READ_AFTER(end); \
+    } \
+    COMPILER_MEMORY_FENCE(); \
+    last_func(ep, tag); \
+    PUSH_RESULT(&ring, send_start_end); \
+    PARK(ep); \
+    return 0; \
+}
+
+IPC_NBSEND_RECV_FUNC(ipc_nbsendrecv_func2, DO_REAL_NBSEND, end)
+IPC_NBSEND_RECV_FUNC(ipc_nbsendrecv_func, dummy_seL4_Send, start)
+#endif /* CONFIG_KERNEL_RT */
+
+/* write a word in decimal, without snprintf, which shallow clones cannot use */
+static void word_to_string(seL4_Word word, char string[WORD_STRING_SIZE])
+{
+    char digits[WORD_STRING_SIZE];
+    int n = 0;
+    do {
+        digits[n++] = '0' + word % 10;
+        word /= 10;
+    } while (word != 0);
+
+    for (int i = 0; i < n; i++) {
+        string[i] = digits[n - i - 1];
+    }
+    string[n] = '\0';
+}
+
+/*
+ * Entry point of a thread in the worker pool: run each helper function pushed to its command ring,
+ * with the same arguments as it would be spawned with. Each function is followed by whether it is
+ * a cold run, the message length and the number of extra caps. The function is pushed as its
+ * address rather than its index in bench_funcs, which shallow clones cannot read as it is data.
+ */
+seL4_Word ipc_worker(int argc, char *argv[])
+{
+    result_ring_t commands = result_ring_from_args(&argv[COMMAND_ARG]);
+    char *cold_cache = argv[COLD_CACHE_ARG];
+    /* not a string literal, as shallow clones have no data */
+    char no_cold_cache[] = {'0', '\0'};
+    char length[WORD_STRING_SIZE];
+    char extra_caps[WORD_STRING_SIZE];
+    argv[LENGTH_ARG] = length;
+    argv[EXTRA_CAPS_ARG] = extra_caps;
+    while (true) {
+        helper_func_t fn = (helper_func_t) (uintptr_t) result_ring_pop(&commands);
+        argv[COLD_CACHE_ARG] = result_ring_pop(&commands) ? cold_cache : no_cold_cache;
+        word_to_string(result_ring_pop(&commands), length);
+        word_to_string(result_ring_pop(&commands), extra_caps);
+        fn(argc, argv);
+    }
+    return 0;
+}
+
 #define MEASURE_OVERHEAD(op, dest, decls) do { \
     uint32_t i; \
     timing_init(); \
@@ -278,22 +758,113 @@ static void measure_overhead(ipc_results_t *results)
     MEASURE_OVERHEAD(DO_NOP_REPLY_RECV_10(0, tag10, 0),
                      results->overhead_benchmarks[REPLY_RECV_10_OVERHEAD],
                      seL4_MessageInfo_t tag10 = seL4_MessageInfo_new(0, 0, 0, 10));
+    MEASURE_OVERHEAD(DO_NOP_NBSEND(0, tag),
+                     results->overhead_benchmarks[NBSEND_OVERHEAD],
+                     seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0));
+    MEASURE_OVERHEAD(DO_NOP_POLL(0),
+                     results->overhead_benchmarks[POLL_OVERHEAD],
+                     {});
+#ifdef CONFIG_KERNEL_RT
+    MEASURE_OVERHEAD(DO_NOP_NBSEND_RECV(0, tag, 0),
+                     results->overhead_benchmarks[NBSEND_RECV_OVERHEAD],
+                     seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0));
+    MEASURE_OVERHEAD(DO_NOP_NBSEND_WAIT(0, tag),
+                     results->overhead_benchmarks[NBSEND_WAIT_OVERHEAD],
+                     seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, 0));
+#endif
+}
+
+/* pop a timestamp, and the generic counters read with it if CONFIG_ALL_COUNTERS */
+static ccnt_t pop_result(result_ring_t *ring, ccnt_t counters[SEL4BENCH_NUM_GENERIC_EVENTS])
+{
+    ccnt_t result = result_ring_pop(ring);
+    if (config_set(CONFIG_ALL_COUNTERS)) {
+        for (int c = 0; c < num_used_counters(); c++) {
+            counters[c] = result_ring_pop(ring);
+        }
+    }
+    return result;
+}
+
+/* time between the timestamps of client and server, which are in either order */
+static inline ccnt_t time_between(ccnt_t end, ccnt_t start)
+{
+    return end > start ? end - start : start - end;
+}
+
+/* does the server tell us it is initialised on CONFIG_KERNEL_RT? Servers that only receive do not,
+ * as they would take the client's first message */
+static inline bool server_handshakes(const benchmark_params_t *params)
+{
+    return params->server_fn != IPC_RECV_FUNC && params->server_fn != IPC_POLL_FUNC;
+}
+
+/* run a helper function in a helper thread, by spawning it or by sending it to the worker */
+static int start_helper(env_t *env, helper_thread_t *helper, helper_func_id_t fn, bool cold,
+                        const benchmark_params_t *params)
+{
+    if (config_set(CONFIG_IPC_WORKER_POOL)) {
+        result_ring_push(&helper->commands, (uintptr_t) bench_funcs[fn]);
+        result_ring_push(&helper->commands, cold);
+        result_ring_push(&helper->commands, params->length);
+        result_ring_push(&helper->commands, params->extra_caps);
+        result_ring_flush(&helper->commands);
+        return 0;
+    }
+
+    /* the helper only pollutes the caches if it is given the buffer */
+    snprintf(helper->argv_strings[COLD_CACHE_ARG], WORD_STRING_SIZE, "%" PRIuPTR,
+             cold ? (uintptr_t) helper->cold_cache : 0);
+    snprintf(helper->argv_strings[LENGTH_ARG], WORD_STRING_SIZE, "%" PRIuPTR,
+             (uintptr_t) params->length);
+    snprintf(helper->argv_strings[EXTRA_CAPS_ARG], WORD_STRING_SIZE, "%" PRIuPTR,
+             (uintptr_t) params->extra_caps);
+    helper->process.entry_point = bench_funcs[fn];
+    return benchmark_spawn_process(&helper->process, &env->slab_vka, &env->vspace, NUM_ARGS,
+                                   helper->argv, 1);
+}
+
+/* set up the arguments of a helper thread */
+static void init_helper_args(helper_thread_t *helper, seL4_CPtr reply)
+{
+    sel4utils_create_word_args(helper->argv_strings, helper->argv, NUM_ARGS, helper->ep,
+                               helper->ring_args[0], helper->ring_args[1], helper->ring_args[2],
+                               reply, helper->command_args[0], helper->command_args[1],
+                               helper->command_args[2], (seL4_Word) helper->cold_cache, 0, 0,
+                               helper->badged_ep, helper->cap, 0, helper->park);
+}
+
+/* set up the arguments of a helper thread, and start it if it is a worker */
+static void init_helper(env_t *env, helper_thread_t *helper, seL4_CPtr reply)
+{
+    init_helper_args(helper, reply);
+
+    if (config_set(CONFIG_IPC_WORKER_POOL)) {
+        helper->process.entry_point = ipc_worker;
+        int error = benchmark_spawn_process(&helper->process, &env->slab_vka, &env->vspace,
+                                            NUM_ARGS, helper->argv, 1);
+        ZF_LOGF_IF(error, "Failed to spawn worker");
+    }
 }
 
-void run_bench(env_t *env, cspacepath_t result_ep_path, seL4_CPtr ep,
-               const benchmark_params_t *params,
+void run_bench(env_t *env, seL4_CPtr ep,
+               const benchmark_params_t *params, seL4_Word chunk, bool cold,
                ccnt_t *ret1, ccnt_t *ret2,
+               ccnt_t counters1[SEL4BENCH_NUM_GENERIC_EVENTS],
+               ccnt_t counters2[SEL4BENCH_NUM_GENERIC_EVENTS],
                helper_thread_t *client, helper_thread_t *server)
 {
 
     timing_init();
+#ifdef CONFIG_ALL_COUNTERS
+    sel4bench_enable_generic_counters(chunk, sel4bench_get_num_counters());
+#endif
 
     /* start processes */
-    int error = benchmark_spawn_process(&server->process, &env->slab_vka, &env->vspace, NUM_ARGS,
-                                        server->argv, 1);
+    int error = start_helper(env, server, params->server_fn, cold, params);
     ZF_LOGF_IF(error, "Failed to spawn server\n");
 
-    if (config_set(CONFIG_KERNEL_RT) && params->server_fn != IPC_RECV_FUNC) {
+    if (config_set(CONFIG_KERNEL_RT) && server_handshakes(params)) {
         /* wait for server to tell us its initialised */
         seL4_Wait(ep, NULL);
 
@@ -305,23 +876,102 @@ void run_bench(env_t *env, cspacepath_t result_ep_path, seL4_CPtr ep,
         }
     }
 
-    error = benchmark_spawn_process(&client->process, &env->slab_vka, &env->vspace, NUM_ARGS, client->argv, 1);
+    error = start_helper(env, client, params->client_fn, cold, params);
     ZF_LOGF_IF(error, "Failed to spawn client\n");
 
     /* get results */
-    *ret1 = get_result(result_ep_path.capPtr);
+    *ret1 = pop_result(&client->ring, counters1);
 
-    if (config_set(CONFIG_KERNEL_RT) && params->server_fn != IPC_RECV_FUNC && params->passive) {
-        /* convert server to active so it can send us the result */
+    if (config_set(CONFIG_KERNEL_RT) && server_handshakes(params) && params->passive) {
+        /* convert server to active so it can push its result */
         error = api_sc_bind(server->process.thread.sched_context.cptr,
                             server->process.thread.tcb.cptr);
         ZF_LOGF_IF(error, "Failed to convert server to active");
     }
 
-    *ret2 = get_result(result_ep_path.capPtr);
+    *ret2 = pop_result(&server->ring, counters2);
+
+    /* clean up - clean server first in case it is sharing the client's cspace and vspace. Workers
+     * go back to waiting for their next command by themselves. */
+    if (!config_set(CONFIG_IPC_WORKER_POOL)) {
+        seL4_TCB_Suspend(client->process.thread.tcb.cptr);
+        seL4_TCB_Suspend(server->process.thread.tcb.cptr);
+    }
+
+    timing_destroy();
+}
+
+/* set up the server of the contention benchmark in an address space of its own, and its clients
+ * as threads in the client's address space */
+static void init_contention(env_t *env, cspacepath_t ep_path, helper_thread_t *client,
+                            helper_thread_t *server, helper_thread_t clients[IPC_CONTENTION_MAX_CLIENTS])
+{
+    benchmark_shallow_clone_process(env, &server->process, IPC_CONTENTION_SERVER_PRIO, 0,
+                                    "contention server");
+    server->ep = sel4utils_copy_path_to_process(&server->process, ep_path);
+    benchmark_init_result_ring(env, &server->process, 1, &server->ring, server->ring_args);
+    init_helper_args(server, SEL4UTILS_REPLY_SLOT);
+
+    vka_object_t park;
+    if (vka_alloc_notification(&env->slab_vka, &park) != 0) {
+        ZF_LOGF("Failed to allocate notification for contention clients");
+    }
+    cspacepath_t park_path;
+    vka_cspace_make_path(&env->slab_vka, park.cptr, &park_path);
+    seL4_CPtr park_cap = sel4utils_copy_path_to_process(&client->process, park_path);
+
+    for (int c = 0; c < IPC_CONTENTION_MAX_CLIENTS; c++) {
+        char name[WORD_STRING_SIZE + 20];
+        snprintf(name, sizeof(name), "contention client %d", c);
+        benchmark_configure_thread_in_process(env, &client->process, &clients[c].process,
+                                              ipc_contention_client_prio(c), 0, name);
+        clients[c].ep = client->ep;
+        clients[c].park = park_cap;
+        benchmark_init_result_ring(env, &client->process, 1, &clients[c].ring, clients[c].ring_args);
+        init_helper_args(&clients[c], 0);
+    }
+}
+
+/* run BIT(level) clients of the contention benchmark against its server. These are spawned every
+ * time, even with CONFIG_IPC_WORKER_POOL. */
+static void run_contention(env_t *env, seL4_CPtr ep, int level, int run, helper_thread_t *server,
+                           helper_thread_t clients[IPC_CONTENTION_MAX_CLIENTS],
+                           ipc_results_t *results)
+{
+    int n_clients = BIT(level);
+    seL4_Word messages = n_clients * WARMUPS;
+
+    timing_init();
+
+    snprintf(server->argv_strings[MESSAGES_ARG], WORD_STRING_SIZE, "%" PRIuPTR,
+             (uintptr_t) messages);
+    server->process.entry_point = ipc_contention_server_func;
+    int error = benchmark_spawn_process(&server->process, &env->slab_vka, &env->vspace, NUM_ARGS,
+                                        server->argv, 1);
+    ZF_LOGF_IF(error, "Failed to spawn contention server");
+
+    if (config_set(CONFIG_KERNEL_RT)) {
+        /* wait for server to tell us its initialised */
+        seL4_Wait(ep, NULL);
+    }
+
+    /* the clients only run once this thread blocks, and as they all have a higher priority than
+     * the server, each makes its first call before the server handles any */
+    for (int c = 0; c < n_clients; c++) {
+        clients[c].process.entry_point = ipc_contention_client_func;
+        error = benchmark_spawn_process(&clients[c].process, &env->slab_vka, &env->vspace,
+                                        NUM_ARGS, clients[c].argv, 1);
+        ZF_LOGF_IF(error, "Failed to spawn contention client %d", c);
+    }
+
+    results->contention_throughput[level][run] = result_ring_pop(&server->ring) / (messages - 1);
+    for (int c = 0; c < n_clients; c++) {
+        results->contention_latency[level][c][run] = result_ring_pop(&clients[c].ring);
+    }
 
-    /* clean up - clean server first in case it is sharing the client's cspace and vspace */
-    seL4_TCB_Suspend(client->process.thread.tcb.cptr);
+    for (int c = 0; c < n_clients; c++) {
+        seL4_TCB_Suspend(clients[c].process.thread.tcb.cptr);
+    }
     seL4_TCB_Suspend(server->process.thread.tcb.cptr);
 
     timing_destroy();
@@ -330,15 +980,19 @@ void run_bench(env_t *env, cspacepath_t result_ep_path, seL4_CPtr ep,
 int main(int argc, char **argv)
 {
     env_t *env;
-    vka_object_t ep, result_ep;
-    cspacepath_t ep_path, result_ep_path;
+    vka_object_t ep;
+    cspacepath_t ep_path;
 
     static size_t object_freq[seL4_ObjectTypeCount] = {
-        [seL4_TCBObject] = 4,
-        [seL4_EndpointObject] = 2,
+        [seL4_TCBObject] = 4 + N_INTERFERENCE_THREADS + CONTENTION_THREADS,
+        [seL4_EndpointObject] = 1,
+        /* a doorbell and space notification for each result ring, and each command ring, one to
+         * transfer, and one for contention clients to wait on */
+        [seL4_NotificationObject] = (config_set(CONFIG_IPC_WORKER_POOL) ? 13 : 7) +
+                                    2 * CONTENTION_THREADS + 1,
 #ifdef CONFIG_KERNEL_RT
-        [seL4_SchedContextObject] = 4,
-        [seL4_ReplyObject] = 4
+        [seL4_SchedContextObject] = 4 + N_INTERFERENCE_THREADS + CONTENTION_THREADS,
+        [seL4_ReplyObject] = 4 + N_INTERFERENCE_THREADS + CONTENTION_THREADS
 #endif
     };
 
@@ -352,46 +1006,85 @@ int main(int argc, char **argv)
     }
     vka_cspace_make_path(&env->slab_vka, ep.cptr, &ep_path);
 
-    /* allocate result ep - the IPC threads will send their timestamps
-       to this ep */
-    if (vka_alloc_endpoint(&env->slab_vka, &result_ep) != 0) {
-        ZF_LOGF("Failed to allocate endpoint");
-    }
-    vka_cspace_make_path(&env->slab_vka, result_ep.cptr, &result_ep_path);
-
     /* measure benchmarking overhead */
     measure_overhead(results);
 
-    helper_thread_t client, server_thread, server_process;
+    helper_thread_t client = {0}, server_thread = {0}, server_process = {0};
 
     benchmark_shallow_clone_process(env, &client.process, seL4_MinPrio, 0, "client");
     benchmark_shallow_clone_process(env, &server_process.process, seL4_MinPrio, 0, "server process");
     benchmark_configure_thread_in_process(env, &client.process, &server_thread.process, seL4_MinPrio, 0, "server thread");
 
     client.ep = sel4utils_copy_path_to_process(&client.process, ep_path);
-    client.result_ep = sel4utils_copy_path_to_process(&client.process, result_ep_path);
-
     server_process.ep = sel4utils_copy_path_to_process(&server_process.process, ep_path);
-    server_process.result_ep = sel4utils_copy_path_to_process(&server_process.process, result_ep_path);
-
     server_thread.ep = client.ep;
-    server_thread.result_ep = client.result_ep;
 
-    sel4utils_create_word_args(client.argv_strings, client.argv, NUM_ARGS, client.ep, client.result_ep, 0);
-    sel4utils_create_word_args(server_process.argv_strings, server_process.argv, NUM_ARGS,
-                               server_process.ep, server_process.result_ep, SEL4UTILS_REPLY_SLOT);
-    sel4utils_create_word_args(server_thread.argv_strings, server_thread.argv, NUM_ARGS,
-                               server_thread.ep, server_thread.result_ep, SEL4UTILS_REPLY_SLOT);
+    /* caps for the client to send, and a slot for the server in the other address space to
+     * receive them in */
+    vka_object_t ntfn;
+    if (vka_alloc_notification(&env->slab_vka, &ntfn) != 0) {
+        ZF_LOGF("Failed to allocate notification to transfer");
+    }
+    cspacepath_t ntfn_path;
+    vka_cspace_make_path(&env->slab_vka, ntfn.cptr, &ntfn_path);
+    client.cap = sel4utils_copy_path_to_process(&client.process, ntfn_path);
+    client.badged_ep = sel4utils_mint_cap_to_process(&client.process, ep_path, seL4_AllRights,
+                                                     UNWRAPPED_BADGE);
+    server_process.cap = server_process.process.cspace_next_free++;
+
+    /* the IPC threads push their timestamps into these rings. The server thread shares the
+     * client's address space and cspace, but needs a ring of its own. */
+    benchmark_init_result_ring(env, &client.process, 1, &client.ring, client.ring_args);
+    benchmark_init_result_ring(env, &server_process.process, 1, &server_process.ring,
+                               server_process.ring_args);
+    benchmark_init_result_ring(env, &client.process, 1, &server_thread.ring, server_thread.ring_args);
+
+    /* the rings are used the other way around to send workers the helper functions to run */
+    if (config_set(CONFIG_IPC_WORKER_POOL)) {
+        benchmark_init_result_ring(env, &client.process, 1, &client.commands, client.command_args);
+        benchmark_init_result_ring(env, &server_process.process, 1, &server_process.commands,
+                                   server_process.command_args);
+        benchmark_init_result_ring(env, &client.process, 1, &server_thread.commands,
+                                   server_thread.command_args);
+    }
+
+    /* for cold cache runs, the helpers pollute the caches themselves */
+    void *cold_cache = benchmark_init_cold_cache(env);
+    client.cold_cache = benchmark_share_cold_cache(env, &client.process, cold_cache);
+    server_process.cold_cache = benchmark_share_cold_cache(env, &server_process.process, cold_cache);
+    server_thread.cold_cache = client.cold_cache;
+
+    init_helper(env, &client, 0);
+    init_helper(env, &server_process, SEL4UTILS_REPLY_SLOT);
+    init_helper(env, &server_thread, SEL4UTILS_REPLY_SLOT);
+
+    benchmark_interference_t interference;
+    benchmark_init_interference(env, &interference);
+
+    static helper_thread_t contention_server, contention_clients[IPC_CONTENTION_MAX_CLIENTS];
+    if (config_set(CONFIG_IPC_CONTENTION)) {
+        init_contention(env, ep_path, &client, &contention_server, contention_clients);
+    }
 
     /* run the benchmark */
     seL4_CPtr auth = simple_get_tcb(&env->simple);
     ccnt_t start, end;
-    for (int i = 0; i < RUNS; i++) {
+    ccnt_t start_counters[SEL4BENCH_NUM_GENERIC_EVENTS], end_counters[SEL4BENCH_NUM_GENERIC_EVENTS];
+    seL4_Word n_counters = sel4bench_get_num_counters();
+    /* with CONFIG_ALL_COUNTERS, each benchmark is run once for each chunk of generic counters */
+    seL4_Word n_chunks = config_set(CONFIG_ALL_COUNTERS) ?
+                         sel4bench_get_num_generic_counter_chunks(n_counters) : 1;
+    const char *config = env->args->config;
+    size_t runs = runtime_config_runs(config, RUNS);
+    for (int i = 0; i < runs; i++) {
         int j;
         ZF_LOGI("--------------------------------------------------\n");
         ZF_LOGI("Doing iteration %d\n", i);
         ZF_LOGI("--------------------------------------------------\n");
         for (j = 0; j < ARRAY_SIZE(benchmark_params); j++) {
+            if (!runtime_config_param_enabled(config, j)) {
+                continue;
+            }
             const struct benchmark_params *params = &benchmark_params[j];
             ZF_LOGI("%s\t: IPC duration (%s), client prio: %3d server prio %3d, %s vspace, %s, length %2d\n",
                     params->name,
@@ -403,26 +1096,81 @@ int main(int argc, char **argv)
             /* set up client for benchmark */
             int error = seL4_TCB_SetPriority(client.process.thread.tcb.cptr, auth, params->client_prio);
             ZF_LOGF_IF(error, "Failed to set client prio");
-            client.process.entry_point = bench_funcs[params->client_fn];
 
             if (params->same_vspace) {
                 error = seL4_TCB_SetPriority(server_thread.process.thread.tcb.cptr, auth, params->server_prio);
                 assert(error == seL4_NoError);
-                server_thread.process.entry_point = bench_funcs[params->server_fn];
             } else {
                 error = seL4_TCB_SetPriority(server_process.process.thread.tcb.cptr, auth, params->server_prio);
                 assert(error == seL4_NoError);
-                server_process.process.entry_point = bench_funcs[params->server_fn];
             }
 
-            run_bench(env, result_ep_path, ep_path.capPtr, params, &end, &start, &client,
-                      params->same_vspace ? &server_thread : &server_process);
+            for (seL4_Word chunk = 0; chunk < n_chunks; chunk++) {
+                run_bench(env, ep_path.capPtr, params, chunk, false, &end, &start, end_counters,
+                          start_counters, &client,
+                          params->same_vspace ? &server_thread : &server_process);
 
-            if (end > start) {
-                results->benchmarks[j][i] = end - start;
-            } else {
-                results->benchmarks[j][i] = start - end;
+                /* the cycle counts of each chunk are equivalent, keep the first */
+                if (chunk == 0) {
+                    results->benchmarks[CACHE_HOT][j][i] = time_between(end, start);
+                }
+
+                if (!config_set(CONFIG_ALL_COUNTERS)) {
+                    continue;
+                }
+                for (int c = 0; c < num_used_counters(); c++) {
+                    seL4_Word event = chunk * n_counters + c;
+                    if (event >= N_COUNTED_EVENTS) {
+                        break;
+                    }
+                    results->benchmark_events[j][event][i] = end > start ?
+                                                             end_counters[c] - start_counters[c] :
+                                                             start_counters[c] - end_counters[c];
+                }
+            }
+
+            /* cold runs are only measured in cycles */
+            for (int cache = CACHE_COLD; cache < N_CACHE_STATES; cache++) {
+                run_bench(env, ep_path.capPtr, params, 0, true, &end, &start, end_counters,
+                          start_counters, &client,
+                          params->same_vspace ? &server_thread : &server_process);
+                results->benchmarks[cache][j][i] = time_between(end, start);
+            }
+
+            /* as are runs under memory interference */
+            for (int level = 0; config_set(CONFIG_MEMORY_INTERFERENCE) && level < N_INTERFERENCE_LEVELS; level++) {
+                benchmark_set_interference(&interference, level);
+                run_bench(env, ep_path.capPtr, params, 0, false, &end, &start, end_counters,
+                          start_counters, &client,
+                          params->same_vspace ? &server_thread : &server_process);
+                results->interference[level][j][i] = time_between(end, start);
             }
+            benchmark_set_interference(&interference, 0);
+        }
+
+        /* the length sweep, with hot caches and only in cycles */
+        for (j = 0; config_set(CONFIG_IPC_LENGTH_SWEEP) && j < ARRAY_SIZE(length_sweep_params); j++) {
+            benchmark_params_t params = length_sweep_params[j];
+            ZF_LOGI("%s\t: IPC length sweep\n", params.name);
+
+            int error = seL4_TCB_SetPriority(client.process.thread.tcb.cptr, auth, params.client_prio);
+            ZF_LOGF_IF(error, "Failed to set client prio");
+            error = seL4_TCB_SetPriority(server_process.process.thread.tcb.cptr, auth, params.server_prio);
+            ZF_LOGF_IF(error, "Failed to set server prio");
+
+            for (int length = 0; length < N_SWEEP_LENGTHS; length++) {
+                params.length = length;
+                run_bench(env, ep_path.capPtr, &params, 0, false, &end, &start, end_counters,
+                          start_counters, &client, &server_process);
+                results->length_sweep[j][length][i] = time_between(end, start);
+            }
+        }
+
+        /* endpoint contention, with hot caches and only in cycles */
+        for (int level = 0; config_set(CONFIG_IPC_CONTENTION) && level < N_CONTENTION_LEVELS; level++) {
+            ZF_LOGI("Endpoint contention\t: %lu clients\n", BIT(level));
+            run_contention(env, ep_path.capPtr, level, i, &contention_server, contention_clients,
+                           results);
         }
     }
 
@@ -56,6 +56,8 @@ static seL4_CPtr done_ep;
 static seL4_CPtr timer_signal;
 /* timer */
 seL4_timer_t *timer;
+/* buffer for ticker to pollute the caches with between irqs, NULL for hot cache runs */
+static void *cold_cache;
 
 void ticker_fn(ccnt_t *results, volatile ccnt_t *current_time)
 {
@@ -72,6 +74,10 @@ void ticker_fn(ccnt_t *results, volatile ccnt_t *current_time)
         end_low = (seL4_Word) end;
         start = (seL4_Word) * current_time;
         results[i] = end_low - start;
+        if (cold_cache != NULL) {
+            /* the spinner touches very little before the next irq */
+            benchmark_pollute_caches(cold_cache);
+        }
     }
 
     seL4_Signal(done_ep);
@@ -84,11 +90,11 @@ int main(int argc, char **argv)
     vka_object_t endpoint = {0};
 
     static size_t object_freq[seL4_ObjectTypeCount] = {
-        [seL4_TCBObject] = 2,
+        [seL4_TCBObject] = 2 + N_INTERFERENCE_THREADS,
         [seL4_EndpointObject] = 1,
 #ifdef CONFIG_KERNEL_RT
-        [seL4_SchedContextObject] = 2,
-        [seL4_ReplyObject] = 2
+        [seL4_SchedContextObject] = 2 + N_INTERFERENCE_THREADS,
+        [seL4_ReplyObject] = 2 + N_INTERFERENCE_THREADS
 #endif
     };
 
@@ -129,37 +135,73 @@ int main(int argc, char **argv)
         ZF_LOGF("Failed to allocate page");
     }
 
+    /* with CONFIG_COLD_CACHE, each benchmark is run again, with the ticker polluting the caches
+     * after each irq */
+    void *cold_cache_buffer = benchmark_init_cold_cache(env);
+
+    /* with CONFIG_MEMORY_INTERFERENCE, each benchmark is run again under each number of
+     * interferers */
+    benchmark_interference_t interference;
+    benchmark_init_interference(env, &interference);
+
     /* first run the benchmark between two threads in the current address space */
     benchmark_configure_thread(env, endpoint.cptr, seL4_MaxPrio - 1, "ticker", &ticker);
     benchmark_configure_thread(env, endpoint.cptr, seL4_MaxPrio - 2, "spinner", &spinner);
 
-    error = sel4utils_start_thread(&ticker, (sel4utils_thread_entry_fn) ticker_fn, (void *) results->thread_results,
-                                   (void *) local_current_time, true);
-    if (error) {
-        ZF_LOGF("Failed to start ticker");
-    }
-
     char strings[1][WORD_STRING_SIZE];
     char *spinner_argv[1];
 
-    sel4utils_create_word_args(strings, spinner_argv, 1, (seL4_Word) local_current_time);
-    error = sel4utils_start_thread(&spinner, (sel4utils_thread_entry_fn) spinner_fn, (void *) 1, (void *) spinner_argv,
-                                   true);
-    assert(!error);
+    for (int cache = CACHE_HOT; cache < N_CACHE_STATES; cache++) {
+        cold_cache = cache == CACHE_COLD ? cold_cache_buffer : NULL;
+        error = sel4utils_start_thread(&ticker, (sel4utils_thread_entry_fn) ticker_fn,
+                                       (void *) results->thread_results[cache],
+                                       (void *) local_current_time, true);
+        if (error) {
+            ZF_LOGF("Failed to start ticker");
+        }
 
-    benchmark_wait_children(endpoint.cptr, "child of irq-user", 1);
+        sel4utils_create_word_args(strings, spinner_argv, 1, (seL4_Word) local_current_time);
+        error = sel4utils_start_thread(&spinner, (sel4utils_thread_entry_fn) spinner_fn, (void *) 1, (void *) spinner_argv,
+                                       true);
+        assert(!error);
+
+        benchmark_wait_children(endpoint.cptr, "child of irq-user", 1);
+
+        /* stop spinner thread */
+        error = seL4_TCB_Suspend(spinner.tcb.cptr);
+        assert(error == seL4_NoError);
+
+        error = seL4_TCB_Suspend(ticker.tcb.cptr);
+        assert(error == seL4_NoError);
+    }
 
-    /* stop spinner thread */
-    error = seL4_TCB_Suspend(spinner.tcb.cptr);
-    assert(error == seL4_NoError);
+    cold_cache = NULL;
+    for (int level = 0; config_set(CONFIG_MEMORY_INTERFERENCE) && level < N_INTERFERENCE_LEVELS; level++) {
+        benchmark_set_interference(&interference, level);
+        error = sel4utils_start_thread(&ticker, (sel4utils_thread_entry_fn) ticker_fn,
+                                       (void *) results->thread_interference[level],
+                                       (void *) local_current_time, true);
+        assert(!error);
 
-    error = seL4_TCB_Suspend(ticker.tcb.cptr);
-    assert(error == seL4_NoError);
+        error = sel4utils_start_thread(&spinner, (sel4utils_thread_entry_fn) spinner_fn, (void *) 1, (void *) spinner_argv,
+                                       true);
+        assert(!error);
+
+        benchmark_wait_children(endpoint.cptr, "child of irq-user", 1);
+
+        error = seL4_TCB_Suspend(spinner.tcb.cptr);
+        assert(error == seL4_NoError);
+
+        error = seL4_TCB_Suspend(ticker.tcb.cptr);
+        assert(error == seL4_NoError);
+    }
+    benchmark_set_interference(&interference, 0);
 
     /* now run the benchmark again, but run the spinner in another address space */
 
     /* restart ticker */
-    error = sel4utils_start_thread(&ticker, (sel4utils_thread_entry_fn) ticker_fn, (void *) results->process_results,
+    error = sel4utils_start_thread(&ticker, (sel4utils_thread_entry_fn) ticker_fn,
+                                   (void *) results->process_results[CACHE_HOT],
                                    (void *) local_current_time, true);
     assert(!error);
 
@@ -181,6 +223,36 @@ int main(int argc, char **argv)
 
     benchmark_wait_children(endpoint.cptr, "child of irq-user", 1);
 
+    /* the spinner process keeps running for the cold cache runs */
+    for (int cache = CACHE_COLD; cache < N_CACHE_STATES; cache++) {
+        error = seL4_TCB_Suspend(ticker.tcb.cptr);
+        assert(error == seL4_NoError);
+
+        cold_cache = cold_cache_buffer;
+        error = sel4utils_start_thread(&ticker, (sel4utils_thread_entry_fn) ticker_fn,
+                                       (void *) results->process_results[cache],
+                                       (void *) local_current_time, true);
+        assert(!error);
+
+        benchmark_wait_children(endpoint.cptr, "child of irq-user", 1);
+    }
+
+    /* and under interference */
+    cold_cache = NULL;
+    for (int level = 0; config_set(CONFIG_MEMORY_INTERFERENCE) && level < N_INTERFERENCE_LEVELS; level++) {
+        error = seL4_TCB_Suspend(ticker.tcb.cptr);
+        assert(error == seL4_NoError);
+
+        benchmark_set_interference(&interference, level);
+        error = sel4utils_start_thread(&ticker, (sel4utils_thread_entry_fn) ticker_fn,
+                                       (void *) results->process_interference[level],
+                                       (void *) local_current_time, true);
+        assert(!error);
+
+        benchmark_wait_children(endpoint.cptr, "child of irq-user", 1);
+    }
+    benchmark_set_interference(&interference, 0);
+
     /* done -> results are stored in shared memory so we can now return */
     benchmark_finished(EXIT_SUCCESS);
     return 0;
@@ -17,7 +17,10 @@
 #include <page_mapping.h>
 
 #define START_ADDR 0x60000000
-#define NUM_ARGS 3
+/* result ring, untyped, number of pages */
+#define NUM_ARGS (RESULT_RING_NUM_ARGS + 2)
+#define UNTYPED_ARG RESULT_RING_NUM_ARGS
+#define NPAGE_ARG (RESULT_RING_NUM_ARGS + 1)
 
 #if defined(CONFIG_ARCH_X86_64)
 #define DEFAULT_DEPTH 64
@@ -34,7 +37,9 @@
 typedef struct helper_thread {
     sel4utils_process_t process;
     seL4_CPtr untyped;
-    seL4_CPtr result_ep;
+    /* phase timings from the process */
+    result_ring_t ring;
+    seL4_Word ring_args[RESULT_RING_NUM_ARGS];
     int npage;
     char *argv[NUM_ARGS];
     char argv_strings[NUM_ARGS][WORD_STRING_SIZE];
@@ -128,9 +133,9 @@ PROT_UNPROT_NPAGE(unprot_pages, seL4_AllRights)
 static void
 bench_proc(int argc UNUSED, char *argv[])
 {
-    seL4_CPtr result_ep = (seL4_CPtr)atoi(argv[0]);
-    seL4_CPtr untyped = (seL4_CPtr)atoi(argv[1]);
-    int npage = atoi(argv[2]);
+    result_ring_t ring = result_ring_from_args(argv);
+    seL4_CPtr untyped = (seL4_CPtr)atoi(argv[UNTYPED_ARG]);
+    int npage = atoi(argv[NPAGE_ARG]);
     seL4_CPtr free_slot = untyped + 1;
     seL4_Word addr = START_ADDR;
     ccnt_t start, end;
@@ -146,7 +151,7 @@ bench_proc(int argc UNUSED, char *argv[])
 
     SEL4BENCH_READ_CCNT(end);
     COMPILER_MEMORY_FENCE();
-    send_result(result_ep, end - start);
+    result_ring_push(&ring, end - start);
 
     seL4_CPtr page_ptr_start = free_slot;
     /* allocate pages */
@@ -157,7 +162,7 @@ bench_proc(int argc UNUSED, char *argv[])
 
     SEL4BENCH_READ_CCNT(end);
     COMPILER_MEMORY_FENCE();
-    send_result(result_ep, end - start);
+    result_ring_push(&ring, end - start);
 
     /* Do the real mapping */
     COMPILER_MEMORY_FENCE();
@@ -167,7 +172,7 @@ bench_proc(int argc UNUSED, char *argv[])
 
     SEL4BENCH_READ_CCNT(end);
     COMPILER_MEMORY_FENCE();
-    send_result(result_ep, end - start);
+    result_ring_push(&ring, end - start);
 
     /* Protect mapped page as seL4_CanRead */
     COMPILER_MEMORY_FENCE();
@@ -177,7 +182,7 @@ bench_proc(int argc UNUSED, char *argv[])
 
     SEL4BENCH_READ_CCNT(end);
     COMPILER_MEMORY_FENCE();
-    send_result(result_ep, end - start);
+    result_ring_push(&ring, end - start);
 
     /* Unprotect it back */
     COMPILER_MEMORY_FENCE();
@@ -187,7 +192,10 @@ bench_proc(int argc UNUSED, char *argv[])
 
     SEL4BENCH_READ_CCNT(end);
     COMPILER_MEMORY_FENCE();
-    send_result(result_ep, end - start);
+    result_ring_push(&ring, end - start);
+
+    /* the phases are collected together, instead of stopping to send each one */
+    result_ring_flush(&ring);
 
     /* cleaning */
     long err;
@@ -206,7 +214,6 @@ bench_proc(int argc UNUSED, char *argv[])
 }
 
 static void run_bench_child_proc(env_t *env,
-                                 cspacepath_t *result_ep_path,
                                  ccnt_t result[NPHASE],
                                  helper_thread_t *proc
                                 )
@@ -219,7 +226,7 @@ static void run_bench_child_proc(env_t *env,
 
     /* Get result from benchmarking process */
     for (int i = 0; i < NPHASE; i++) {
-        result[i] = get_result(result_ep_path->capPtr);
+        result[i] = result_ring_pop(&proc->ring);
     }
 }
 
@@ -246,13 +253,14 @@ int main(int argc, char *argv[])
 {
     env_t *env;
     page_mapping_results_t *results;
-    vka_object_t result_ep, untyped_obj;
-    cspacepath_t result_ep_path, untyped_path;
+    vka_object_t untyped_obj;
+    cspacepath_t untyped_path;
     helper_thread_t proc;
 
     static size_t object_freq[seL4_ObjectTypeCount] = {
         [seL4_TCBObject] = 1,
-        [seL4_EndpointObject] = 1,
+        /* result ring doorbell and space notifications */
+        [seL4_NotificationObject] = 2,
 #ifdef CONFIG_KERNEL_RT
         [seL4_SchedContextObject] = 1,
         [seL4_ReplyObject] = 1
@@ -263,12 +271,6 @@ int main(int argc, char *argv[])
                             object_freq);
     results = (page_mapping_results_t *)env->results;
 
-    /* allocate result end point */
-    if (vka_alloc_endpoint(&env->slab_vka, &result_ep) != 0) {
-        ZF_LOGF("Failed to allocate endpoint");
-    }
-    vka_cspace_make_path(&env->slab_vka, result_ep.cptr, &result_ep_path);
-
     /* allocate untyped cap for pages */
     if ((vka_alloc_untyped(&env->delegate_vka, env->args->untyped_size_bits - 2,
                            &untyped_obj)) != 0) {
@@ -282,22 +284,38 @@ int main(int argc, char *argv[])
     benchmark_shallow_clone_process(env, &proc.process, seL4_MaxPrio,
                                     bench_proc, "Proc");
 
-    proc.result_ep = sel4utils_copy_path_to_process(&proc.process,
-                                                    result_ep_path);
+    /* keep the result ring out of the range the benchmark maps pages into */
+    int max_npage = 0;
+    for (int j = 0; j < TESTS; j++) {
+        max_npage = MAX(max_npage, page_mapping_benchmark_params[j].npage);
+    }
+    reservation_t reservation = vspace_reserve_range_at(&proc.process.vspace, (void *) START_ADDR,
+                                                        NUM_PAGE_TABLE(max_npage) * PAGE_PER_TABLE *
+                                                        PAGE_SIZE_4K, seL4_AllRights, 1);
+    ZF_LOGF_IF(reservation.res == NULL, "Failed to reserve range for benchmark mappings");
+
+    /* set up before the untyped is copied in, which must stay in the last slot */
+    benchmark_init_result_ring(env, &proc.process, 1, &proc.ring, proc.ring_args);
 
     measure_overhead(results);
-    for (int i = 0; i < RUNS; i++) {
+    const char *config = env->args->config;
+    size_t runs = runtime_config_runs(config, RUNS);
+    for (int i = 0; i < runs; i++) {
         for (int j = 0; j < TESTS; j++) {
+            if (!runtime_config_param_enabled(config, j)) {
+                continue;
+            }
             proc.untyped = sel4utils_copy_path_to_process(&proc.process,
                                                           untyped_path);
             proc.npage = page_mapping_benchmark_params[j].npage;
 
             sel4utils_create_word_args(proc.argv_strings, proc.argv, NUM_ARGS,
-                                       proc.result_ep, proc.untyped, proc.npage);
+                                       proc.ring_args[0], proc.ring_args[1], proc.ring_args[2],
+                                       proc.untyped, proc.npage);
 
             /* run test */
             ccnt_t ret_time[NPHASE] = {0};
-            run_bench_child_proc(env, &result_ep_path, ret_time, &proc);
+            run_bench_child_proc(env, ret_time, &proc);
             /* record result */
             for (int k = 0; k < NPHASE; k++) {
                 results->benchmarks_result[j][k][i] = ret_time[k];
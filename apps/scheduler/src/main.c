@@ -165,6 +165,7 @@ static void benchmark_prio_threads(env_t *env, seL4_CPtr ep, seL4_CPtr produce,
                                    ccnt_t results[N_PRIOS][N_RUNS])
 {
     sel4utils_thread_t high, low;
+    benchmark_checkpoint_t high_cp;
     char high_args_strings[N_HIGH_ARGS][WORD_STRING_SIZE];
     char *high_argv[N_HIGH_ARGS];
     char low_args_strings[N_LOW_ARGS][WORD_STRING_SIZE];
@@ -177,6 +178,10 @@ static void benchmark_prio_threads(env_t *env, seL4_CPtr ep, seL4_CPtr produce,
 
     sel4utils_create_word_args(high_args_strings, high_argv, N_HIGH_ARGS, produce,
                                ep, (seL4_Word) &start, consume);
+    error = sel4utils_start_thread(&high, (sel4utils_thread_entry_fn) high_fn, (void *) N_HIGH_ARGS, (void *) high_argv, 0);
+    assert(error == seL4_NoError);
+    /* high's arguments are the same for every run, so reset it rather than restarting it */
+    benchmark_checkpoint_thread(&high, &high_cp);
 
     for (int i = 0; i < N_PRIOS; i++) {
         uint8_t prio = gen_next_prio(i);
@@ -188,8 +193,7 @@ static void benchmark_prio_threads(env_t *env, seL4_CPtr ep, seL4_CPtr produce,
 
         error = sel4utils_start_thread(&low, (sel4utils_thread_entry_fn) low_fn, (void *) N_LOW_ARGS, (void *) low_argv, 1);
         assert(error == seL4_NoError);
-        error = sel4utils_start_thread(&high, (sel4utils_thread_entry_fn) high_fn, (void *) N_HIGH_ARGS, (void *) high_argv, 1);
-        assert(error == seL4_NoError);
+        benchmark_restore_thread(&high_cp, true);
 
         benchmark_wait_children(ep, "children of scheduler benchmark", 2);
     }
@@ -202,6 +206,7 @@ static void benchmark_prio_processes(env_t *env, seL4_CPtr ep, seL4_CPtr produce
                                      ccnt_t results[N_PRIOS][N_RUNS])
 {
     sel4utils_process_t high;
+    benchmark_checkpoint_t high_cp;
     sel4utils_thread_t low;
     char high_args_strings[N_HIGH_ARGS][WORD_STRING_SIZE];
     char *high_argv[N_HIGH_ARGS];
@@ -241,6 +246,10 @@ static void benchmark_prio_processes(env_t *env, seL4_CPtr ep, seL4_CPtr produce
 
     sel4utils_create_word_args(high_args_strings, high_argv, N_HIGH_ARGS, remote_produce,
                                remote_ep, (seL4_Word) remote_start, remote_consume);
+    error = benchmark_spawn_process(&high, &env->slab_vka, &env->vspace, N_HIGH_ARGS, high_argv, 0);
+    assert(error == seL4_NoError);
+    /* spawning a process is expensive, so reset it instead of spawning it for every run */
+    benchmark_checkpoint_thread(&high.thread, &high_cp);
 
     for (int i = 0; i < N_PRIOS; i++) {
         uint8_t prio = gen_next_prio(i);
@@ -253,8 +262,7 @@ static void benchmark_prio_processes(env_t *env, seL4_CPtr ep, seL4_CPtr produce
         error = sel4utils_start_thread(&low, (sel4utils_thread_entry_fn) low_fn, (void *) N_LOW_ARGS, (void *) low_argv, 1);
         assert(error == seL4_NoError);
 
-        error = benchmark_spawn_process(&high, &env->slab_vka, &env->vspace, N_HIGH_ARGS, high_argv, 1);
-        assert(error == seL4_NoError);
+        benchmark_restore_thread(&high_cp, true);
 
         benchmark_wait_children(ep, "children of scheduler benchmark", 2);
     }
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+#include <autoconf.h>
+#include <sel4benchapp/gen_config.h>
+#include <inttypes.h>
+#include <platsupport/ltimer.h>
+#include <sel4bench/sel4bench.h>
+#include <sel4platsupport/timer.h>
+#include <utils/time.h>
+#include <utils/util.h>
+
+#include "calibration.h"
+
+uint64_t calibrate_cycle_counter(env_t *env)
+{
+    if (!config_set(CONFIG_CALIBRATE_CYCLE_COUNTER)) {
+        return 0;
+    }
+
+    int error = sel4platsupport_init_default_timer_ops(&env->vka, &env->vspace, &env->simple,
+                                                       env->ops, env->timer_ntfn.cptr, &env->timer);
+    if (error) {
+        ZF_LOGE("Failed to initialise timer, results will only be reported in cycles");
+        return 0;
+    }
+
+#ifdef CONFIG_CALIBRATE_CYCLE_COUNTER
+    uint64_t interval = (uint64_t) CONFIG_CALIBRATION_INTERVAL * NS_IN_MS;
+#else
+    uint64_t interval = 0;
+#endif
+    uint64_t start_ns, end_ns;
+    ccnt_t start, end;
+
+    sel4bench_init();
+    error = ltimer_get_time(&env->timer.ltimer, &start_ns);
+    SEL4BENCH_READ_CCNT(start);
+    end_ns = start_ns;
+    while (!error && end_ns - start_ns < interval) {
+        error = ltimer_get_time(&env->timer.ltimer, &end_ns);
+    }
+    SEL4BENCH_READ_CCNT(end);
+    sel4bench_destroy();
+
+    sel4platsupport_destroy_timer(&env->timer, &env->vka);
+    if (error || end_ns == start_ns) {
+        ZF_LOGE("Failed to read timer, results will only be reported in cycles");
+        return 0;
+    }
+
+    /* the counter may have wrapped once, if it is 32 bits */
+    uint64_t frequency = (uint64_t)((double)(ccnt_t)(end - start) * NS_IN_S / (end_ns - start_ns));
+    ZF_LOGI("Cycle counter runs at %"PRIu64" Hz", frequency);
+    return frequency;
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "env.h"
+
+/*
+ * Measure the frequency of the cycle counter, see CalibrateCycleCounter.
+ *
+ * The cycle counter is read at the start and end of CONFIG_CALIBRATION_INTERVAL ms, timed with
+ * the platform timer, which is set up with env->ops and env->timer_ntfn and released again
+ * before this returns. This must be called before the watchdog takes the timer.
+ *
+ * @return the frequency in Hz, or 0 if calibration is disabled or the timer is not available.
+ */
+uint64_t calibrate_cycle_counter(env_t *env);
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#include <cpio/cpio.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/util.h>
+#include <runtime_config.h>
+
+#include "config_file.h"
+
+/* the cpio archive holding the benchmark apps, which the config file is added to */
+extern char _cpio_archive[];
+extern char _cpio_archive_end[];
+
+/* strip whitespace from both ends of a string of length len, returning the new length */
+static size_t strip(const char **str, size_t len)
+{
+    while (len > 0 && isspace((unsigned char) **str)) {
+        (*str)++;
+        len--;
+    }
+    while (len > 0 && isspace((unsigned char)(*str)[len - 1])) {
+        len--;
+    }
+    return len;
+}
+
+static benchmark_t *find_benchmark(benchmark_t *benchmarks[], const char *name, size_t len)
+{
+    for (int i = 0; benchmarks[i] != NULL; i++) {
+        if (strlen(benchmarks[i]->name) == len && strncmp(benchmarks[i]->name, name, len) == 0) {
+            return benchmarks[i];
+        }
+    }
+    return NULL;
+}
+
+static void apply_line(benchmark_t *benchmarks[], const char *line, size_t len, int line_no)
+{
+    len = strip(&line, len);
+    if (len == 0 || line[0] == '#') {
+        return;
+    }
+
+    const char *equals = memchr(line, '=', len);
+    const char *dot = memchr(line, '.', len);
+    if (equals == NULL || dot == NULL || dot > equals) {
+        ZF_LOGE(RUNTIME_CONFIG_FILE ":%d: expected <benchmark>.<setting> = <value>", line_no);
+        return;
+    }
+
+    benchmark_t *benchmark = find_benchmark(benchmarks, line, dot - line);
+    if (benchmark == NULL) {
+        ZF_LOGE(RUNTIME_CONFIG_FILE ":%d: unknown benchmark %.*s", line_no, (int)(dot - line), line);
+        return;
+    }
+
+    const char *key = dot + 1;
+    size_t key_len = strip(&key, equals - key);
+    const char *value = equals + 1;
+    size_t value_len = strip(&value, line + len - value);
+
+    if (key_len == strlen("enabled") && strncmp(key, "enabled", key_len) == 0) {
+        bool enabled = strtol(value, NULL, 0) != 0;
+        if (enabled && !benchmark->enabled) {
+            ZF_LOGE(RUNTIME_CONFIG_FILE ":%d: %s benchmark was not built, cannot enable it",
+                    line_no, benchmark->name);
+        } else {
+            benchmark->enabled = enabled;
+        }
+        return;
+    }
+
+    size_t used = strlen(benchmark->config);
+    int n = snprintf(&benchmark->config[used], RUNTIME_CONFIG_SIZE - used, "%.*s=%.*s\n",
+                     (int) key_len, key, (int) value_len, value);
+    if (n < 0 || (size_t) n >= RUNTIME_CONFIG_SIZE - used) {
+        ZF_LOGE(RUNTIME_CONFIG_FILE ":%d: too many settings for %s benchmark", line_no,
+                benchmark->name);
+        benchmark->config[used] = '\0';
+    }
+}
+
+void config_file_apply(benchmark_t *benchmarks[])
+{
+    unsigned long size;
+    const char *file = cpio_get_file(_cpio_archive, _cpio_archive_end - _cpio_archive,
+                                     RUNTIME_CONFIG_FILE, &size);
+    if (file == NULL) {
+        return;
+    }
+
+    printf("Applying runtime config from " RUNTIME_CONFIG_FILE "\n");
+    int line_no = 1;
+    for (const char *line = file; line < file + size; line_no++) {
+        const char *end = memchr(line, '\n', file + size - line);
+        if (end == NULL) {
+            end = file + size;
+        }
+        apply_line(benchmarks, line, end - line, line_no);
+        line = end + 1;
+    }
+}
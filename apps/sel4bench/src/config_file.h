@@ -0,0 +1,27 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#pragma once
+
+#include "benchmark.h"
+
+/*
+ * Apply the runtime config file from the cpio archive, if there is one, to the benchmarks.
+ *
+ * Each line of the file is a "<benchmark>.<setting> = <value>" pair. Blank lines and lines
+ * starting with # are ignored. The "enabled" setting can disable a benchmark that was built
+ * (a benchmark that was not built cannot be enabled), and every other setting is copied to the
+ * config of the benchmark, see runtime_config.h.
+ *
+ * @param benchmarks NULL terminated list of benchmarks.
+ */
+void config_file_apply(benchmark_t *benchmarks[]);
@@ -31,6 +31,10 @@ typedef struct env {
     vka_object_t untyped;
     timer_objects_t to;
     ps_io_ops_t ops;
+    /* timer for calibration (see calibration.h) and then the watchdog (see watchdog.h) */
+    seL4_timer_t timer;
+    /* notification for the timer, bound to the driver's thread */
+    vka_object_t timer_ntfn;
 } env_t;
 
 /* do any platform specific set up */
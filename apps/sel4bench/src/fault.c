@@ -16,8 +16,18 @@
 #include <fault.h>
 #include <stdio.h>
 
-static json_t *
-fault_process(void *results) {
+/* process the results of each cache state, ignoring the extra result at the end of each */
+static void
+process_cache_states(ccnt_t array[N_CACHE_STATES][N_RUNS + 1], result_desc_t desc,
+                     result_t results[N_CACHE_STATES])
+{
+    for (int i = 0; i < N_CACHE_STATES; i++) {
+        results[i] = process_result(N_RUNS, array[i], desc);
+    }
+}
+
+static int
+fault_process(void *results, json_writer_t *writer) {
     fault_results_t *raw_results = results;
 
     result_desc_t desc = {
@@ -36,19 +46,17 @@ fault_process(void *results) {
         .results = &result
     };
 
-    json_t *array = json_array();
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     desc.stable = false;
     desc.overhead = result.min;
 
-    set.name = "fault round trip";
-    result = process_result(N_RUNS, raw_results->round_trip, desc);
-    json_array_append_new(array, result_set_to_json(set));
+    result_t cache_results[N_CACHE_STATES];
+    process_cache_states(raw_results->round_trip, desc, cache_results);
+    json_write_cache_states(writer, "fault round trip", cache_results);
 
-    set.name = "faulter -> fault handler";
-    result = process_result(N_RUNS, raw_results->fault, desc);
-    json_array_append_new(array, result_set_to_json(set));
+    process_cache_states(raw_results->fault, desc, cache_results);
+    json_write_cache_states(writer, "faulter -> fault handler", cache_results);
 
     /* calculate the overhead of reading the cycle count (fault handler -> faulter path
      * does not include a call to seL4_ReplyRecv_ */
@@ -57,16 +65,15 @@ fault_process(void *results) {
     desc.stable = true;
     desc.overhead = 0;
     result = process_result(N_RUNS, raw_results->ccnt_overhead, desc);
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     /* fault to fault handler does not */
-    set.name = "fault handler -> faulter";
     desc.stable = false;
     desc.overhead = result.min;
-    result = process_result(N_RUNS, raw_results->fault_reply, desc);
-    json_array_append_new(array, result_set_to_json(set));
+    process_cache_states(raw_results->fault_reply, desc, cache_results);
+    json_write_cache_states(writer, "fault handler -> faulter", cache_results);
 
-    return array;
+    return 0;
 }
 
 static benchmark_t fault_benchmark = {
@@ -16,8 +16,8 @@
 #include <hardware.h>
 #include <stdio.h>
 
-static json_t *
-hardware_process(void *results) {
+static int
+hardware_process(void *results, json_writer_t *writer) {
     hardware_results_t *raw_results = results;
 
     result_desc_t desc = {
@@ -40,14 +40,13 @@ hardware_process(void *results) {
         .results = &result
     };
 
-    json_t *array = json_array();
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     set.name = "Nop syscall overhead";
     set.results = &nopnulsyscall_result;
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
-    return array;
+    return 0;
 }
 
 static benchmark_t hardware_benchmark = {
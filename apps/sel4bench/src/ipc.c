@@ -12,6 +12,8 @@
 #include <autoconf.h>
 #include <ipc.h>
 #include <jansson.h>
+#include <math.h>
+#include <stdlib.h>
 #include <sel4bench/sel4bench.h>
 #include <utils/util.h>
 
@@ -21,8 +23,308 @@
 #include "printing.h"
 #include "processing.h"
 
-static json_t *
-process_ipc_results(void *r)
+static benchmark_t ipc_benchmark;
+
+/* the benchmarks measure a generic or platform counter instead of cycles */
+#define IPC_COUNTS_EVENTS (config_set(CONFIG_GENERIC_COUNTER) || config_set(CONFIG_PLATFORM_COUNTER))
+
+/* write the table of each selected benchmark against the number of memory interferers */
+static void
+process_interference_results(ipc_results_t *raw_results, ccnt_t overheads[NUM_OVERHEAD_BENCHMARKS],
+                             int n_benchmarks, int selected[n_benchmarks], size_t runs,
+                             json_writer_t *writer)
+{
+    int n = n_benchmarks * N_INTERFERENCE_LEVELS;
+    char *functions[n];
+    char *directions[n];
+    bool same_vspace[n];
+    json_int_t length[n];
+    json_int_t extra_caps[n];
+    json_int_t transferred[n];
+    json_int_t interferers[n];
+    char *patterns[n];
+
+    column_t extra_cols[] = {
+        {
+            .header = "Function",
+            .type = JSON_STRING,
+            .string_array = &functions[0]
+        },
+        {
+            .header = "Direction",
+            .type = JSON_STRING,
+            .string_array = &directions[0],
+        },
+        {
+            .header = "Same vspace?",
+            .type = JSON_TRUE,
+            .bool_array = &same_vspace[0]
+        },
+        {
+            .header = "IPC length",
+            .type = JSON_INTEGER,
+            .integer_array = &length[0]
+        },
+        {
+            .header = "Extra caps",
+            .type = JSON_INTEGER,
+            .integer_array = &extra_caps[0]
+        },
+        {
+            .header = "Caps transferred",
+            .type = JSON_INTEGER,
+            .integer_array = &transferred[0]
+        },
+        {
+            .header = "Interferers",
+            .type = JSON_INTEGER,
+            .integer_array = &interferers[0]
+        },
+        {
+            .header = "Pattern",
+            .type = JSON_STRING,
+            .string_array = &patterns[0]
+        },
+    };
+
+    result_t results[n];
+
+    result_set_t result_set = {
+        .name = "One way IPC microbenchmarks under memory interference",
+        .extra_cols = extra_cols,
+        .n_extra_cols = ARRAY_SIZE(extra_cols),
+        .results = results,
+        .n_results = n,
+    };
+
+    for (int i = 0; i < n; i++) {
+        int b = selected[i / N_INTERFERENCE_LEVELS];
+        int level = i % N_INTERFERENCE_LEVELS;
+        result_desc_t desc = {
+            .name = benchmark_params[b].name,
+            .overhead = overheads[benchmark_params[b].overhead_id],
+            .counts_events = IPC_COUNTS_EVENTS,
+        };
+
+        functions[i] = (char *) benchmark_params[b].name;
+        directions[i] = benchmark_params[b].direction == DIR_TO ? "client->server" :
+                                                                  "server->client";
+        same_vspace[i] = benchmark_params[b].same_vspace;
+        length[i] = benchmark_params[b].length;
+        extra_caps[i] = benchmark_params[b].extra_caps;
+        transferred[i] = benchmark_params[b].transfer_cap;
+        interferers[i] = level;
+        patterns[i] = (char *) interference_pattern_name();
+
+        results[i] = process_result(runs, raw_results->interference[level][b], desc);
+    }
+
+    json_write_result_set(writer, result_set);
+}
+
+/* write the table of each length sweep benchmark at each message length, with the difference in
+ * median from one word shorter, which shows where the cost of each word changes. There is nothing
+ * to compare length 0 with, so its marginal cost is null. */
+static void
+process_length_sweep_results(ipc_results_t *raw_results, ccnt_t overheads[NUM_OVERHEAD_BENCHMARKS],
+                             size_t runs, json_writer_t *writer)
+{
+    int n = ARRAY_SIZE(length_sweep_params) * N_SWEEP_LENGTHS;
+    char *functions[n];
+    char *directions[n];
+    json_int_t length[n];
+    double marginal[n];
+
+    column_t extra_cols[] = {
+        {
+            .header = "Function",
+            .type = JSON_STRING,
+            .string_array = &functions[0]
+        },
+        {
+            .header = "Direction",
+            .type = JSON_STRING,
+            .string_array = &directions[0],
+        },
+        {
+            .header = "IPC length",
+            .type = JSON_INTEGER,
+            .integer_array = &length[0]
+        },
+        {
+            .header = "Marginal cost per word",
+            .type = JSON_REAL,
+            .real_array = &marginal[0]
+        },
+    };
+
+    result_t results[n];
+
+    result_set_t result_set = {
+        .name = "One way IPC microbenchmarks by message length",
+        .extra_cols = extra_cols,
+        .n_extra_cols = ARRAY_SIZE(extra_cols),
+        .results = results,
+        .n_results = n,
+    };
+
+    for (int i = 0; i < n; i++) {
+        const benchmark_params_t *params = &length_sweep_params[i / N_SWEEP_LENGTHS];
+        int l = i % N_SWEEP_LENGTHS;
+        result_desc_t desc = {
+            .name = params->name,
+            .overhead = overheads[params->overhead_id],
+            .counts_events = IPC_COUNTS_EVENTS,
+        };
+
+        functions[i] = (char *) params->name;
+        directions[i] = params->direction == DIR_TO ? "client->server" : "server->client";
+        length[i] = l;
+
+        results[i] = process_result(runs, raw_results->length_sweep[i / N_SWEEP_LENGTHS][l], desc);
+        marginal[i] = l == 0 ? NAN : results[i].median - results[i - 1].median;
+    }
+
+    json_write_result_set(writer, result_set);
+}
+
+/* write the tables of the contention benchmark: the time the server takes for each message, and
+ * the round trip time of the clients at each priority, against the number of clients. The client
+ * round trips are timed around a single Call each, so have the Call overhead subtracted. */
+static void
+process_contention_results(ipc_results_t *raw_results, ccnt_t overheads[NUM_OVERHEAD_BENCHMARKS],
+                           size_t runs, json_writer_t *writer)
+{
+    int n = N_CONTENTION_LEVELS;
+    json_int_t clients[n];
+    double throughput[n];
+    result_t results[n];
+
+    column_t throughput_cols[2] = {
+        {
+            .header = "Clients",
+            .type = JSON_INTEGER,
+            .integer_array = &clients[0]
+        },
+    };
+    int n_throughput_cols = 1;
+    /* messages per second can only be calculated from cycles, with a known frequency */
+    if (writer->frequency != 0 && !IPC_COUNTS_EVENTS) {
+        throughput_cols[n_throughput_cols++] = (column_t) {
+            .header = "Messages/s",
+            .type = JSON_REAL,
+            .real_array = &throughput[0]
+        };
+    }
+
+    result_set_t throughput_set = {
+        .name = "IPC endpoint contention, server time per message",
+        .extra_cols = throughput_cols,
+        .n_extra_cols = n_throughput_cols,
+        .results = results,
+        .n_results = n,
+    };
+
+    /* the server times all of its messages at once and divides by their number, so the overhead
+     * of measuring is spread over them and is not subtracted */
+    for (int level = 0; level < n; level++) {
+        result_desc_t desc = {
+            .name = "contention throughput",
+            .counts_events = IPC_COUNTS_EVENTS,
+        };
+        clients[level] = BIT(level);
+        results[level] = process_result(runs, raw_results->contention_throughput[level], desc);
+        throughput[level] = results[level].median > 0 ? writer->frequency / results[level].median : 0;
+    }
+
+    json_write_result_set(writer, throughput_set);
+
+    /* a row for each priority that has clients at each number of clients, with the samples of
+     * all of its clients */
+    int n_rows = 0;
+    for (int level = 0; level < N_CONTENTION_LEVELS; level++) {
+        n_rows += MIN((int) BIT(level), IPC_CONTENTION_PRIOS);
+    }
+    json_int_t row_clients[n_rows];
+    json_int_t client_prios[n_rows];
+    json_int_t server_prios[n_rows];
+    result_t latency[n_rows];
+
+    column_t latency_cols[] = {
+        {
+            .header = "Clients",
+            .type = JSON_INTEGER,
+            .integer_array = &row_clients[0]
+        },
+        {
+            .header = "Client Prio",
+            .type = JSON_INTEGER,
+            .integer_array = &client_prios[0]
+        },
+        {
+            .header = "Server Prio",
+            .type = JSON_INTEGER,
+            .integer_array = &server_prios[0]
+        },
+    };
+
+    result_set_t latency_set = {
+        .name = "IPC endpoint contention, client round trip time",
+        .extra_cols = latency_cols,
+        .n_extra_cols = ARRAY_SIZE(latency_cols),
+        .results = latency,
+        .n_results = n_rows,
+    };
+
+    /* the results refer to the samples, so they are gathered into one buffer that is kept until
+     * they are written */
+    ccnt_t *samples = calloc(N_CONTENTION_LEVELS * IPC_CONTENTION_MAX_CLIENTS * runs, sizeof(ccnt_t));
+    ZF_LOGF_IF(samples == NULL, "Failed to allocate contention samples");
+
+    ccnt_t *next = samples;
+    int row = 0;
+    for (int level = 0; level < N_CONTENTION_LEVELS; level++) {
+        int n_clients = BIT(level);
+        for (int p = 0; p < MIN(n_clients, IPC_CONTENTION_PRIOS); p++) {
+            size_t n_samples = 0;
+            for (int c = p; c < n_clients; c += IPC_CONTENTION_PRIOS) {
+                for (size_t i = 0; i < runs; i++) {
+                    next[n_samples++] = raw_results->contention_latency[level][c][i];
+                }
+            }
+            result_desc_t desc = {
+                .name = "contention latency",
+                .overhead = overheads[CALL_OVERHEAD],
+                .counts_events = IPC_COUNTS_EVENTS,
+            };
+            row_clients[row] = n_clients;
+            client_prios[row] = ipc_contention_client_prio(p);
+            server_prios[row] = IPC_CONTENTION_SERVER_PRIO;
+            latency[row] = process_result(n_samples, next, desc);
+            next += n_samples;
+            row++;
+        }
+    }
+
+    json_write_result_set(writer, latency_set);
+    free(samples);
+}
+
+/* write the tables of the benchmarks that are not selected by the runtime config params */
+static void
+process_extra_results(ipc_results_t *raw_results, ccnt_t overheads[NUM_OVERHEAD_BENCHMARKS],
+                      size_t runs, json_writer_t *writer)
+{
+    if (config_set(CONFIG_IPC_LENGTH_SWEEP)) {
+        process_length_sweep_results(raw_results, overheads, runs, writer);
+    }
+    if (config_set(CONFIG_IPC_CONTENTION)) {
+        process_contention_results(raw_results, overheads, runs, writer);
+    }
+}
+
+static int
+process_ipc_results(void *r, json_writer_t *writer)
 {
     ipc_results_t *raw_results = r;
     ccnt_t overheads[NUM_OVERHEAD_BENCHMARKS];
@@ -34,7 +336,7 @@ process_ipc_results(void *r)
                 printf("Benchmarking overhead of a %s is not stable! Cannot continue\n",
                         overhead_benchmark_params[i].name);
                 print_all(RUNS, raw_results->overhead_benchmarks[i]);
-                return NULL;
+                return -1;
             }
         }
         result_desc_t desc = {
@@ -48,15 +350,40 @@ process_ipc_results(void *r)
         overheads[i] = overhead_result.min;
     }
 
-    int n = ARRAY_SIZE(benchmark_params);
+    /* with CONFIG_ALL_COUNTERS each benchmark has a row for the cycle counter followed by a row
+     * for each generic event, and with CONFIG_COLD_CACHE these are followed by a row for the
+     * cycle counter with cold caches */
+    int event_rows = config_set(CONFIG_ALL_COUNTERS) ? NUM_AVERAGE_EVENTS : 1;
+    int rows_per_benchmark = event_rows + N_CACHE_STATES - 1;
+
+    /* only the benchmarks selected by the runtime config were run */
+    const char *config = ipc_benchmark.config;
+    size_t runs = runtime_config_runs(config, RUNS);
+    int n_benchmarks = runtime_config_num_params(config, ARRAY_SIZE(benchmark_params));
+    if (n_benchmarks == 0) {
+        process_extra_results(raw_results, overheads, runs, writer);
+        return 0;
+    }
+    int selected[n_benchmarks];
+    for (int i = 0, b = 0; i < ARRAY_SIZE(benchmark_params); i++) {
+        if (runtime_config_param_enabled(config, i)) {
+            selected[b++] = i;
+        }
+    }
+
+    int n = n_benchmarks * rows_per_benchmark;
     char *functions[n];
     char *directions[n];
     json_int_t client_prios[n];
     json_int_t server_prios[n];
     bool same_vspace[n];
     json_int_t length[n];
+    json_int_t extra_caps[n];
+    json_int_t transferred[n];
+    char *events[n];
+    char *caches[n];
 
-    column_t extra_cols[] = {
+    column_t extra_cols[10] = {
         {
             .header = "Function",
             .type = JSON_STRING,
@@ -86,40 +413,88 @@ process_ipc_results(void *r)
             .header = "IPC length",
             .type = JSON_INTEGER,
             .integer_array = &length[0]
-        }
+        },
+        {
+            .header = "Extra caps",
+            .type = JSON_INTEGER,
+            .integer_array = &extra_caps[0]
+        },
+        {
+            .header = "Caps transferred",
+            .type = JSON_INTEGER,
+            .integer_array = &transferred[0]
+        },
     };
+    int n_extra_cols = 8;
+    if (config_set(CONFIG_COLD_CACHE)) {
+        extra_cols[n_extra_cols++] = (column_t) {
+            .header = "Cache",
+            .type = JSON_STRING,
+            .string_array = &caches[0]
+        };
+    }
+    if (config_set(CONFIG_ALL_COUNTERS)) {
+        extra_cols[n_extra_cols++] = (column_t) {
+            .header = "Event",
+            .type = JSON_STRING,
+            .string_array = &events[0]
+        };
+    }
 
     result_t results[n];
 
     result_set_t result_set = {
         .name = "One way IPC microbenchmarks",
         .extra_cols = extra_cols,
-        .n_extra_cols = ARRAY_SIZE(extra_cols),
+        .n_extra_cols = n_extra_cols,
         .results = results,
         .n_results = n,
     };
 
     /* now calculate the results */
     for (int i = 0; i < n; i++) {
+        int b = selected[i / rows_per_benchmark];
+        int row = i % rows_per_benchmark;
         result_desc_t desc = {
-            .name = benchmark_params[i].name,
-            .overhead = overheads[benchmark_params[i].overhead_id],
+            .name = benchmark_params[b].name,
+            .overhead = overheads[benchmark_params[b].overhead_id],
+            .counts_events = IPC_COUNTS_EVENTS,
         };
 
-        functions[i] = (char *) benchmark_params[i].name,
-        directions[i] = benchmark_params[i].direction == DIR_TO ? "client->server" :
+        functions[i] = (char *) benchmark_params[b].name,
+        directions[i] = benchmark_params[b].direction == DIR_TO ? "client->server" :
                                                                   "server->client";
-        client_prios[i] = benchmark_params[i].client_prio;
-        server_prios[i] = benchmark_params[i].server_prio;
-        same_vspace[i] = benchmark_params[i].same_vspace;
-        length[i] = benchmark_params[i].length;
+        client_prios[i] = benchmark_params[b].client_prio;
+        server_prios[i] = benchmark_params[b].server_prio;
+        same_vspace[i] = benchmark_params[b].same_vspace;
+        length[i] = benchmark_params[b].length;
+        extra_caps[i] = benchmark_params[b].extra_caps;
+        transferred[i] = benchmark_params[b].transfer_cap;
+
+        /* rows after the events are cold cache rows */
+        int cache = row < event_rows ? CACHE_HOT : row - event_rows + 1;
+        int event = row < event_rows ? row : 0;
+        caches[i] = (char *) cache_state_name(cache);
 
-        results[i] = process_result(RUNS, raw_results->benchmarks[i], desc);
+        if (event == 0) {
+            events[i] = "Cycle counter";
+            results[i] = process_result(runs, raw_results->benchmarks[cache][b], desc);
+        } else {
+            /* the overheads are only measured in cycles */
+            desc.overhead = 0;
+            desc.counts_events = true;
+            events[i] = (char *) GENERIC_EVENT_NAMES[event - 1];
+            results[i] = process_result(runs, raw_results->benchmark_events[b][event - 1], desc);
+        }
     }
 
-    json_t *array = json_array();
-    json_array_append_new(array, result_set_to_json(result_set));
-    return array;
+    json_write_result_set(writer, result_set);
+
+    if (config_set(CONFIG_MEMORY_INTERFERENCE)) {
+        process_interference_results(raw_results, overheads, n_benchmarks, selected, runs, writer);
+    }
+    process_extra_results(raw_results, overheads, runs, writer);
+    return 0;
 }
 
 static benchmark_t ipc_benchmark = {
@@ -32,8 +32,8 @@ static ccnt_t kernel_log_data[KERNEL_MAX_NUM_LOG_ENTRIES];
 static unsigned int offsets[CONFIG_MAX_NUM_TRACE_POINTS];
 static unsigned int sizes[CONFIG_MAX_NUM_TRACE_POINTS];
 
-static json_t *
-process(void *results) {
+static int
+process(void *results, json_writer_t *writer) {
      irq_results_t *irq_results = (irq_results_t *) results;
 
     /* Sort and group data by tracepoints. A stable sort is used so the first N_IGNORED
@@ -72,7 +72,6 @@ process(void *results) {
         ZF_LOGF("Failed to allocate memory\n");
     }
 
-    json_t *array = json_array();
     result_desc_t desc = {0};
     result_t result = process_result(n_overhead_data, overhead_data, desc);
 
@@ -82,7 +81,7 @@ process(void *results) {
         .results = &result,
     };
 
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     /* Add the results from the IRQ path tracepoints to get the total IRQ path cycle counts.
      * The average overhead is subtracted from each cycle count (doubled as there are 2
@@ -97,11 +96,11 @@ process(void *results) {
     set.name = "IRQ Path Cycle Count (accounting for overhead)";
 
     result = process_result(n_data, data, desc);
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     free(data);
 
-    return array;
+    return 0;
 }
 
 static benchmark_t irq_benchmark = {
@@ -118,8 +117,8 @@ irq_benchmark_new(void)
     return &irq_benchmark;
 }
 
-static json_t *
-irquser_process(void *r) {
+static int
+irquser_process(void *r, json_writer_t *writer) {
     irquser_results_t *raw_results = r;
 
     result_desc_t desc = {
@@ -127,39 +126,105 @@ irquser_process(void *r) {
         .name = "IRQ user measurement overhead"
     };
 
-    result_t results[3];
+    /* the overhead, followed by each cache state of both benchmarks */
+    int n = 1 + 2 * N_CACHE_STATES;
+    result_t results[n];
+    char *types[n];
+    char *caches[n];
 
     results[0] = process_result(N_RUNS, raw_results->overheads, desc);
+    types[0] = "Measurement overhead";
+    caches[0] = (char *) cache_state_name(CACHE_HOT);
 
     desc.overhead = results[0].min;
 
-    results[1] = process_result(N_RUNS, raw_results->thread_results, desc);
-    results[2] = process_result(N_RUNS, raw_results->process_results, desc);
-
-    char *types[] = {"Measurement overhead", "Without context switch", "With context switch"};
+    for (int cache = 0; cache < N_CACHE_STATES; cache++) {
+        int i = 1 + 2 * cache;
+        results[i] = process_result(N_RUNS, raw_results->thread_results[cache], desc);
+        types[i] = "Without context switch";
+        results[i + 1] = process_result(N_RUNS, raw_results->process_results[cache], desc);
+        types[i + 1] = "With context switch";
+        caches[i] = caches[i + 1] = (char *) cache_state_name(cache);
+    }
 
-    column_t col = {
-        .header = "Type",
-        .type = JSON_STRING,
-        .string_array = types
+    column_t cols[] = {
+        {
+            .header = "Type",
+            .type = JSON_STRING,
+            .string_array = types
+        },
+        /* only output with CONFIG_COLD_CACHE */
+        {
+            .header = "Cache",
+            .type = JSON_STRING,
+            .string_array = caches
+        }
     };
 
     result_set_t set = {
         .name = "IRQ path cycle count (measured from user level)",
-        .n_results = 3,
+        .n_results = n,
         .results = results,
-        .n_extra_cols = 1,
-        .extra_cols = &col
+        .n_extra_cols = N_CACHE_STATES > 1 ? 2 : 1,
+        .extra_cols = cols
     };
 
-    json_t *json = json_array();
-    json_array_append_new(json, result_set_to_json(set));
-    return json;
+    json_write_result_set(writer, set);
+
+    if (config_set(CONFIG_MEMORY_INTERFERENCE)) {
+        /* each number of interferers of both benchmarks */
+        int n_interference = 2 * N_INTERFERENCE_LEVELS;
+        result_t interference_results[n_interference];
+        char *interference_types[n_interference];
+        json_int_t interferers[n_interference];
+        char *patterns[n_interference];
+
+        for (int level = 0; level < N_INTERFERENCE_LEVELS; level++) {
+            int i = 2 * level;
+            interference_results[i] = process_result(N_RUNS, raw_results->thread_interference[level], desc);
+            interference_types[i] = "Without context switch";
+            interference_results[i + 1] = process_result(N_RUNS, raw_results->process_interference[level],
+                                                         desc);
+            interference_types[i + 1] = "With context switch";
+            interferers[i] = interferers[i + 1] = level;
+            patterns[i] = patterns[i + 1] = (char *) interference_pattern_name();
+        }
+
+        column_t interference_cols[] = {
+            {
+                .header = "Type",
+                .type = JSON_STRING,
+                .string_array = interference_types
+            },
+            {
+                .header = "Interferers",
+                .type = JSON_INTEGER,
+                .integer_array = interferers
+            },
+            {
+                .header = "Pattern",
+                .type = JSON_STRING,
+                .string_array = patterns
+            }
+        };
+
+        result_set_t interference_set = {
+            .name = "IRQ path cycle count under memory interference (measured from user level)",
+            .n_results = n_interference,
+            .results = interference_results,
+            .n_extra_cols = ARRAY_SIZE(interference_cols),
+            .extra_cols = interference_cols
+        };
+
+        json_write_result_set(writer, interference_set);
+    }
+    return 0;
 }
 
 static benchmark_t irquser_benchmark = {
     .name = "irquser",
     .enabled = config_set(CONFIG_APP_IRQUSERBENCH),
+    .uses_timer = true,
     .results_pages = BYTES_TO_SIZE_BITS_PAGES(sizeof(irquser_results_t), seL4_PageBits),
     .process = irquser_process,
     .init = blank_init
@@ -10,156 +10,590 @@
  * @TAG(DATA61_GPL)
  */
 #include <autoconf.h>
-#include <benchmark.h>
+#include <sel4benchapp/gen_config.h>
+#include <sel4benchsupport/results.h>
+#include <utils/util.h>
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
 #include "json.h"
+#include "raw_encoding.h"
+
+/* jansson keeps the indent in the bottom 5 bits of the flags */
+#define JSON_WRITER_INDENT(flags) ((flags) & 0x1F)
+/* jansson's default precision for reals */
+#define JSON_WRITER_REAL_PRECISION 17
+
+const char *const result_keys[N_RESULT_KEYS] = {
+    [RESULT_KEY_MIN] = "Min",
+    [RESULT_KEY_MAX] = "Max",
+    [RESULT_KEY_MEAN] = "Mean",
+    [RESULT_KEY_STDDEV] = "Stddev",
+    [RESULT_KEY_VARIANCE] = "Variance",
+    [RESULT_KEY_MODE] = "Mode",
+    [RESULT_KEY_MEDIAN] = "Median",
+    [RESULT_KEY_MEDIAN_CI_LOWER] = "Median CI lower",
+    [RESULT_KEY_MEDIAN_CI_UPPER] = "Median CI upper",
+    [RESULT_KEY_MEAN_CI_LOWER] = "Mean CI lower",
+    [RESULT_KEY_MEAN_CI_UPPER] = "Mean CI upper",
+    [RESULT_KEY_FIRST_QUANTILE] = "1st quantile",
+    [RESULT_KEY_THIRD_QUANTILE] = "3rd quantile",
+    [RESULT_KEY_P90] = "90th percentile",
+    [RESULT_KEY_P99] = "99th percentile",
+    [RESULT_KEY_P999] = "99.9th percentile",
+    [RESULT_KEY_MAD] = "MAD",
+    [RESULT_KEY_TRIMMED_MEAN] = "Trimmed mean",
+    [RESULT_KEY_OUTLIERS] = "Outliers",
+    [RESULT_KEY_SAMPLES] = "Samples",
+    [RESULT_KEY_IGNORED] = "Ignored",
+    [RESULT_KEY_MIN_NS] = "Min (ns)",
+    [RESULT_KEY_MEDIAN_NS] = "Median (ns)",
+    [RESULT_KEY_MEAN_NS] = "Mean (ns)",
+    [RESULT_KEY_RAW_RESULTS] = "Raw results",
+};
+
+/* state for an object or array that is being written */
+typedef struct {
+    /* depth of the container itself, the top level array is 0 */
+    int depth;
+    /* have any members been written yet? */
+    bool empty;
+} json_container_t;
 
-static inline json_t *json_real_check(double val)
+static void
+write_raw(json_writer_t *writer, const char *buf, size_t len)
+{
+    if (writer->file != NULL && len > 0) {
+        UNUSED size_t written = fwrite(buf, 1, len, writer->file);
+        assert(written == len);
+    }
+}
+
+/* equivalent to jansson's dump_indent() */
+static void
+write_indent(json_writer_t *writer, int depth, bool space)
+{
+    static const char whitespace[] = "                                ";
+    size_t indent = JSON_WRITER_INDENT(writer->flags);
+
+    if (indent > 0) {
+        size_t n_spaces = depth * indent;
+        write_raw(writer, "\n", 1);
+        while (n_spaces > 0) {
+            size_t n = MIN(n_spaces, sizeof(whitespace) - 1);
+            write_raw(writer, whitespace, n);
+            n_spaces -= n;
+        }
+    } else if (space && !(writer->flags & JSON_COMPACT)) {
+        write_raw(writer, " ", 1);
+    }
+}
+
+static void
+write_string(json_writer_t *writer, const char *str)
+{
+    write_raw(writer, "\"", 1);
+    while (*str != '\0') {
+        /* write out the longest run of characters that do not need escaping */
+        size_t run = 0;
+        while (str[run] != '\0' && str[run] != '"' && str[run] != '\\' &&
+               (unsigned char) str[run] >= 0x20) {
+            run++;
+        }
+        write_raw(writer, str, run);
+        str += run;
+        if (*str == '\0') {
+            break;
+        }
+
+        char escaped[7];
+        switch (*str) {
+        case '\\':
+            strcpy(escaped, "\\\\");
+            break;
+        case '"':
+            strcpy(escaped, "\\\"");
+            break;
+        case '\b':
+            strcpy(escaped, "\\b");
+            break;
+        case '\f':
+            strcpy(escaped, "\\f");
+            break;
+        case '\n':
+            strcpy(escaped, "\\n");
+            break;
+        case '\r':
+            strcpy(escaped, "\\r");
+            break;
+        case '\t':
+            strcpy(escaped, "\\t");
+            break;
+        default:
+            snprintf(escaped, sizeof(escaped), "\\u%04X", (unsigned char) *str);
+            break;
+        }
+        write_raw(writer, escaped, strlen(escaped));
+        str++;
+    }
+    write_raw(writer, "\"", 1);
+}
+
+static void
+write_integer(json_writer_t *writer, json_int_t value)
+{
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%" JSON_INTEGER_FORMAT, value);
+    write_raw(writer, buf, len);
+}
+
+/* format a real the same way as jansson's jsonp_dtostr() */
+static void
+write_real(json_writer_t *writer, double value)
+{
+    char buf[100];
+    int len = snprintf(buf, sizeof(buf), "%.*g", JSON_WRITER_REAL_PRECISION, value);
+    assert(len > 0 && (size_t) len < sizeof(buf) - 3);
+
+    /* make sure there is a '.' or an 'e' so the value is not read back as an integer */
+    if (strchr(buf, '.') == NULL && strchr(buf, 'e') == NULL) {
+        buf[len++] = '.';
+        buf[len++] = '0';
+        buf[len] = '\0';
+    }
+
+    /* remove the leading '+' and any leading zeroes from the exponent */
+    char *start = strchr(buf, 'e');
+    if (start != NULL) {
+        start++;
+        char *end = start + 1;
+        if (*start == '-') {
+            start++;
+        }
+        while (*end == '0') {
+            end++;
+        }
+        if (end != start) {
+            memmove(start, end, len - (end - buf) + 1);
+            len -= end - start;
+        }
+    }
+
+    write_raw(writer, buf, len);
+}
+
+/* jansson cannot represent nan or inf, so write them as strings instead */
+static void
+write_real_check(json_writer_t *writer, double value)
+{
+    if (isnan(value) || isinf(value)) {
+        write_string(writer, isnan(value) ? "nan" : "inf");
+    } else {
+        write_real(writer, value);
+    }
+}
+
+static void
+write_bool(json_writer_t *writer, bool value)
+{
+    write_raw(writer, value ? "true" : "false", value ? 4 : 5);
+}
+
+static void
+open_container(json_writer_t *writer, json_container_t *container, int depth, bool object)
+{
+    container->depth = depth;
+    container->empty = true;
+    write_raw(writer, object ? "{" : "[", 1);
+}
+
+static void
+next_element(json_writer_t *writer, json_container_t *container)
+{
+    if (!container->empty) {
+        write_raw(writer, ",", 1);
+    }
+    write_indent(writer, container->depth + 1, !container->empty);
+    container->empty = false;
+}
+
+static void
+next_key(json_writer_t *writer, json_container_t *container, const char *key)
+{
+    next_element(writer, container);
+    write_string(writer, key);
+    if (writer->flags & JSON_COMPACT) {
+        write_raw(writer, ":", 1);
+    } else {
+        write_raw(writer, ": ", 2);
+    }
+}
+
+static void
+close_container(json_writer_t *writer, json_container_t *container, bool object)
+{
+    if (!container->empty) {
+        write_indent(writer, container->depth, false);
+    }
+    write_raw(writer, object ? "}" : "]", 1);
+}
+
+/* write samples as a base64 string of raw_encoding frames, see raw_encoding.h */
+static void
+write_encoded_samples(json_writer_t *writer, size_t n, ccnt_t samples[n])
 {
-    json_t *real = json_real(val);
-    if (!real) {
-        return json_string(isnan(val) ? "nan" : "inf");
+    /* static to keep them off the stack, output is only ever written from one thread */
+    static uint64_t frame_samples[RAW_ENCODING_FRAME_SAMPLES];
+    static uint8_t frame[RAW_ENCODING_MAX_FRAME_SIZE];
+    static char encoded[BASE64_ENCODED_SIZE(RAW_ENCODING_MAX_FRAME_SIZE) + 4];
+
+    base64_encoder_t encoder;
+    base64_encoder_init(&encoder);
+
+    write_raw(writer, "\"", 1);
+    for (size_t i = 0; i < n; i += RAW_ENCODING_FRAME_SAMPLES) {
+        size_t n_frame = MIN(n - i, RAW_ENCODING_FRAME_SAMPLES);
+        for (size_t j = 0; j < n_frame; j++) {
+            frame_samples[j] = samples[i + j];
+        }
+        size_t frame_len = raw_encode_frame(n_frame, frame_samples, frame);
+        write_raw(writer, encoded, base64_encode_update(&encoder, frame, frame_len, encoded));
     }
-    return real;
+    write_raw(writer, encoded, base64_encode_finish(&encoder, encoded));
+    write_raw(writer, "\"", 1);
 }
 
 static void
-result_to_json(result_t result, json_t *j)
+result_to_json(json_writer_t *writer, json_container_t *row, result_t result)
 {
-   UNUSED int error = json_object_set_new(j, "Min", json_integer(result.min));
-   assert(error == 0);
+    next_key(writer, row, result_keys[RESULT_KEY_MIN]);
+    write_integer(writer, result.min);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MAX]);
+    write_integer(writer, result.max);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MEAN]);
+    write_real_check(writer, result.mean);
+
+    next_key(writer, row, result_keys[RESULT_KEY_STDDEV]);
+    write_real_check(writer, result.stddev);
+
+    next_key(writer, row, result_keys[RESULT_KEY_VARIANCE]);
+    write_real_check(writer, result.variance);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MODE]);
+    write_real_check(writer, result.mode);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MEDIAN]);
+    write_real_check(writer, result.median);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MEDIAN_CI_LOWER]);
+    write_real_check(writer, result.median_ci_lower);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MEDIAN_CI_UPPER]);
+    write_real_check(writer, result.median_ci_upper);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MEAN_CI_LOWER]);
+    write_real_check(writer, result.mean_ci_lower);
+
+    next_key(writer, row, result_keys[RESULT_KEY_MEAN_CI_UPPER]);
+    write_real_check(writer, result.mean_ci_upper);
+
+    next_key(writer, row, result_keys[RESULT_KEY_FIRST_QUANTILE]);
+    write_real_check(writer, result.first_quantile);
+
+    next_key(writer, row, result_keys[RESULT_KEY_THIRD_QUANTILE]);
+    write_real_check(writer, result.third_quantile);
+
+    next_key(writer, row, result_keys[RESULT_KEY_P90]);
+    write_real_check(writer, result.p90);
+
+    next_key(writer, row, result_keys[RESULT_KEY_P99]);
+    write_real_check(writer, result.p99);
 
-   error = json_object_set_new(j, "Max", json_integer(result.max));
-   assert(error == 0);
+    next_key(writer, row, result_keys[RESULT_KEY_P999]);
+    write_real_check(writer, result.p999);
 
-   error = json_object_set_new(j, "Mean", json_real_check(result.mean));
-   assert(error == 0);
+    next_key(writer, row, result_keys[RESULT_KEY_MAD]);
+    write_real_check(writer, result.mad);
 
-   error = json_object_set_new(j, "Stddev", json_real_check(result.stddev));
-   assert(error == 0);
+    next_key(writer, row, result_keys[RESULT_KEY_TRIMMED_MEAN]);
+    write_real_check(writer, result.trimmed_mean);
 
-   error = json_object_set_new(j, "Variance", json_real_check(result.variance));
-   assert(error == 0);
+    next_key(writer, row, result_keys[RESULT_KEY_OUTLIERS]);
+    write_integer(writer, result.outliers);
 
-   error = json_object_set_new(j, "Mode", json_real_check(result.mode));
-   assert(error == 0);
+    next_key(writer, row, result_keys[RESULT_KEY_SAMPLES]);
+    write_integer(writer, result.samples);
 
-   error = json_object_set_new(j, "Median", json_real_check(result.median));
-   assert(error == 0);
+    next_key(writer, row, result_keys[RESULT_KEY_IGNORED]);
+    write_integer(writer, result.ignored);
 
-   error = json_object_set_new(j, "1st quantile", json_real_check(result.first_quantile));
-   assert(error == 0);
+    if (writer->frequency != 0 && !result.counts_events) {
+        double ns_per_cycle = 1e9 / writer->frequency;
 
-   error = json_object_set_new(j, "3rd quantile", json_real_check(result.third_quantile));
-   assert(error == 0);
+        next_key(writer, row, result_keys[RESULT_KEY_MIN_NS]);
+        write_real_check(writer, result.min * ns_per_cycle);
 
-   error = json_object_set_new(j, "Samples", json_integer(result.samples));
-   assert(error == 0);
+        next_key(writer, row, result_keys[RESULT_KEY_MEDIAN_NS]);
+        write_real_check(writer, result.median * ns_per_cycle);
 
-   json_t *raw_results = json_array();
-   assert(raw_results != NULL);
+        next_key(writer, row, result_keys[RESULT_KEY_MEAN_NS]);
+        write_real_check(writer, result.mean * ns_per_cycle);
+    }
+
+    if (result.raw_data == NULL && result.samples > 0) {
+        /* calculated from a histogram, there are no raw results */
+        return;
+    }
 
-   if (config_set(CONFIG_OUTPUT_RAW_RESULTS)) {
-      for (size_t i = 0; i < result.samples; i++) {
-         error = json_array_append_new(raw_results, json_integer(result.raw_data[i]));
-         assert(error == 0);
-      }
-      json_object_set_new(j, "Raw results", raw_results);
-      assert(error == 0);
-   }
+    if (config_set(CONFIG_OUTPUT_RAW_RESULTS) && config_set(CONFIG_ENCODE_RAW_RESULTS)) {
+        next_key(writer, row, result_keys[RESULT_KEY_RAW_RESULTS]);
+        write_encoded_samples(writer, result.samples, result.raw_data);
+    } else if (config_set(CONFIG_OUTPUT_RAW_RESULTS)) {
+        json_container_t raw_results;
+        next_key(writer, row, result_keys[RESULT_KEY_RAW_RESULTS]);
+        open_container(writer, &raw_results, row->depth + 1, false);
+        for (size_t i = 0; i < result.samples; i++) {
+            next_element(writer, &raw_results);
+            write_integer(writer, result.raw_data[i]);
+        }
+        close_container(writer, &raw_results, false);
+    }
 }
 
-static json_t *
-get_json_cell(column_t column, size_t index)
+static void
+write_cell(json_writer_t *writer, column_t column, size_t index)
 {
     switch (column.type) {
     case JSON_STRING:
-        return json_string(column.string_array[index]);
+        write_string(writer, column.string_array[index]);
+        break;
     case JSON_INTEGER:
-        return json_integer(column.integer_array[index]);
+        write_integer(writer, column.integer_array[index]);
+        break;
     case JSON_REAL:
-        return json_real_check(column.real_array[index]);
+        if (isnan(column.real_array[index])) {
+            write_raw(writer, "null", 4);
+        } else {
+            write_real_check(writer, column.real_array[index]);
+        }
+        break;
     case JSON_TRUE:
     case JSON_FALSE:
-        return json_boolean(column.bool_array[index]);
+        write_bool(writer, column.bool_array[index]);
+        break;
     default:
         ZF_LOGE("Columns of type %d not supported", column.type);
-        return json_null();
+        write_raw(writer, "null", 4);
+        break;
     }
 }
 
-json_t *
-result_set_to_json(result_set_t set)
+/* start a new object in the top level array, leaving it open */
+static void
+open_object(json_writer_t *writer, json_container_t *object)
 {
-   UNUSED int error;
-   json_t *object = json_object();
-   assert(object != NULL);
+    /* the top level array is open between json_writer_start() and json_writer_finish() */
+    if (writer->n_elements > 0) {
+        write_raw(writer, ",", 1);
+    }
+    write_indent(writer, 1, writer->n_elements > 0);
+    writer->n_elements++;
 
-   error = json_object_set_new(object, "Benchmark", json_string(set.name));
-   assert(error == 0);
+    open_container(writer, object, 1, true);
+}
 
-   json_t *rows = json_array();
-   assert(rows != NULL);
+/* start a new {"Benchmark": name, ...} element of the top level array, leaving it open */
+static void
+open_element(json_writer_t *writer, const char *name, json_container_t *object)
+{
+    open_object(writer, object);
+    next_key(writer, object, "Benchmark");
+    write_string(writer, name);
+}
 
-   error = json_object_set_new(object, "Results", rows);
-   assert(error == 0);
+/* start a new {"Benchmark": name, "Results": [...]} element, leaving the results array open */
+static void
+open_benchmark(json_writer_t *writer, const char *name, json_container_t *object,
+               json_container_t *rows)
+{
+    open_element(writer, name, object);
 
-   for (int i = 0; i < set.n_results; i++) {
-       json_t *row = json_object();
-       for (int c = 0; c < set.n_extra_cols; c++) {
-           assert(set.extra_cols != NULL);
-           json_t *cell = get_json_cell(set.extra_cols[c], i);
-           assert(cell != NULL);
+    next_key(writer, object, "Results");
+    open_container(writer, rows, object->depth + 1, false);
+}
 
-           error = json_object_set_new(row, set.extra_cols[c].header, cell);
-           assert(error == 0);
+static void
+close_benchmark(json_writer_t *writer, json_container_t *object, json_container_t *rows)
+{
+    close_container(writer, rows, false);
+    close_container(writer, object, true);
+}
 
-        }
-        result_to_json(set.results[i], row);
+void
+json_writer_start(json_writer_t *writer, FILE *file, size_t flags)
+{
+    writer->file = file;
+    writer->flags = flags;
+    writer->n_elements = 0;
+    writer->frequency = 0;
+    write_raw(writer, "[", 1);
+}
 
-        error = json_array_append_new(rows, row);
-        assert(error == 0);
+void
+json_writer_finish(json_writer_t *writer)
+{
+    if (writer->n_elements > 0) {
+        write_indent(writer, 0, false);
+    }
+    write_raw(writer, "]", 1);
+    if (writer->file != NULL) {
+        fflush(writer->file);
     }
+}
 
-   return object;
+void
+json_writer_set_frequency(json_writer_t *writer, uint64_t frequency)
+{
+    writer->frequency = frequency;
 }
 
-json_t *
-average_counters_to_json(char *name, result_t results[NUM_AVERAGE_EVENTS])
+void
+json_write_metadata(json_writer_t *writer, uint64_t frequency)
 {
-    json_t *obj = json_object();
+    json_container_t object, metadata;
+    open_object(writer, &object);
 
-    assert(obj != NULL);
-    UNUSED int error = json_object_set_new(obj, "Benchmark", json_string(name));
-    assert(error == 0);
+    next_key(writer, &object, "Metadata");
+    open_container(writer, &metadata, object.depth + 1, true);
+    next_key(writer, &metadata, "Cycle counter frequency (Hz)");
+    write_integer(writer, frequency);
+    close_container(writer, &metadata, true);
+
+    close_container(writer, &object, true);
+    json_writer_set_frequency(writer, frequency);
+}
 
-    json_t *rows = json_array();
-    assert(rows != 0);
+void
+json_write_result_set(json_writer_t *writer, result_set_t set)
+{
+    json_container_t object, rows;
+    open_benchmark(writer, set.name, &object, &rows);
+
+    for (int i = 0; i < set.n_results; i++) {
+        json_container_t row;
+        next_element(writer, &rows);
+        open_container(writer, &row, rows.depth + 1, true);
+        for (int c = 0; c < set.n_extra_cols; c++) {
+            assert(set.extra_cols != NULL);
+            next_key(writer, &row, set.extra_cols[c].header);
+            write_cell(writer, set.extra_cols[c], i);
+        }
+        result_to_json(writer, &row, set.results[i]);
+        close_container(writer, &row, true);
+    }
 
-    error = json_object_set_new(obj, "Results", rows);
+    close_benchmark(writer, &object, &rows);
+}
+
+void
+json_write_average_counters(json_writer_t *writer, char *name, result_t results[NUM_AVERAGE_EVENTS])
+{
+    json_container_t object, rows, row;
+    open_benchmark(writer, name, &object, &rows);
 
     for (int i = 0; i < SEL4BENCH_NUM_GENERIC_EVENTS; i++) {
-        json_t *row = json_object();
-        assert(row != NULL);
+        next_element(writer, &rows);
+        open_container(writer, &row, rows.depth + 1, true);
+        next_key(writer, &row, "Event");
+        write_string(writer, GENERIC_EVENT_NAMES[i]);
+        result_t event = results[i];
+        event.counts_events = true;
+        result_to_json(writer, &row, event);
+        close_container(writer, &row, true);
+    }
 
-        error = json_object_set_new(row, "Event",  json_string(GENERIC_EVENT_NAMES[i]));
-        assert(error == 0);
+    next_element(writer, &rows);
+    open_container(writer, &row, rows.depth + 1, true);
+    next_key(writer, &row, "Event");
+    write_string(writer, "Cycle counter");
+    result_to_json(writer, &row, results[CYCLE_COUNT_EVENT]);
+    close_container(writer, &row, true);
 
-        result_to_json(results[i], row);
+    close_benchmark(writer, &object, &rows);
+}
 
-        json_array_append_new(rows, row);
+void
+json_write_cache_states(json_writer_t *writer, char *name, result_t results[N_CACHE_STATES])
+{
+    char *caches[N_CACHE_STATES];
+    for (int i = 0; i < N_CACHE_STATES; i++) {
+        caches[i] = (char *) cache_state_name(i);
     }
 
-    json_t *row = json_object();
-    assert(row != NULL);
+    column_t col = {
+        .header = "Cache",
+        .type = JSON_STRING,
+        .string_array = caches
+    };
+
+    result_set_t set = {
+        .name = name,
+        .n_results = N_CACHE_STATES,
+        .results = results,
+        .n_extra_cols = N_CACHE_STATES > 1 ? 1 : 0,
+        .extra_cols = &col
+    };
+
+    json_write_result_set(writer, set);
+}
 
-    error = json_object_set_new(row, "Event", json_string("Cycle counter"));
-    assert(error == 0);
+void
+json_write_interference(json_writer_t *writer, char *name, result_t results[N_INTERFERENCE_LEVELS])
+{
+    json_int_t interferers[N_INTERFERENCE_LEVELS];
+    char *patterns[N_INTERFERENCE_LEVELS];
+    for (int i = 0; i < N_INTERFERENCE_LEVELS; i++) {
+        interferers[i] = i;
+        patterns[i] = (char *) interference_pattern_name();
+    }
+
+    column_t cols[] = {
+        {
+            .header = "Interferers",
+            .type = JSON_INTEGER,
+            .integer_array = interferers
+        },
+        {
+            .header = "Pattern",
+            .type = JSON_STRING,
+            .string_array = patterns
+        }
+    };
+
+    result_set_t set = {
+        .name = name,
+        .n_results = N_INTERFERENCE_LEVELS,
+        .results = results,
+        .n_extra_cols = ARRAY_SIZE(cols),
+        .extra_cols = cols
+    };
+
+    json_write_result_set(writer, set);
+}
+
+void
+json_write_error(json_writer_t *writer, const char *name, const char *error, int exit_code)
+{
+    json_container_t object;
+    open_element(writer, name, &object);
 
-    result_to_json(results[CYCLE_COUNT_EVENT], row);
+    next_key(writer, &object, "Error");
+    write_string(writer, error);
 
-    error = json_array_append_new(rows, row);
-    assert(error == 0);
+    next_key(writer, &object, "Exit code");
+    write_integer(writer, exit_code);
 
-    return obj;
+    close_container(writer, &object, true);
 }
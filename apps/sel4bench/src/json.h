@@ -12,10 +12,108 @@
 
 #pragma once
 
-#include "benchmark.h"
+#include "results.h"
 #include <jansson.h>
+#include <stdio.h>
 #include <sel4bench/sel4bench.h>
-#include <benchmark.h>
+#include <sel4benchsupport/results.h>
+#include <cold_cache.h>
+#include <interference.h>
 
-json_t *result_set_to_json(result_set_t set);
-json_t *average_counters_to_json(char *name, result_t counters[NUM_AVERAGE_EVENTS]);
+/*
+ * Incremental JSON writer for benchmark output.
+ *
+ * Instead of building a jansson tree for the entire run and dumping it at the end, each result
+ * set is serialised as soon as it has been calculated. The output is formatted exactly as
+ * json_dumpf() would format the equivalent tree with the same flags, but raw samples are read
+ * straight out of the results and never copied, so memory use does not grow with the number of
+ * samples.
+ *
+ * The writer produces a single top level array, with one element per result set or failed
+ * benchmark.
+ */
+typedef struct json_writer {
+    /* where to write the output to - NULL discards all output */
+    FILE *file;
+    /* jansson dump flags, e.g JSON_INDENT(n) */
+    size_t flags;
+    /* number of elements written to the top level array so far */
+    size_t n_elements;
+    /* frequency of the cycle counter in Hz, to convert results to ns, or 0 if it is unknown */
+    uint64_t frequency;
+} json_writer_t;
+
+/*
+ * The columns written for every result, in order: the ns columns only once the frequency of the
+ * cycle counter is known, and the raw results only with OutputRawResults. Any other key in a row
+ * of a result set is an extra column.
+ */
+typedef enum {
+    RESULT_KEY_MIN,
+    RESULT_KEY_MAX,
+    RESULT_KEY_MEAN,
+    RESULT_KEY_STDDEV,
+    RESULT_KEY_VARIANCE,
+    RESULT_KEY_MODE,
+    RESULT_KEY_MEDIAN,
+    RESULT_KEY_MEDIAN_CI_LOWER,
+    RESULT_KEY_MEDIAN_CI_UPPER,
+    RESULT_KEY_MEAN_CI_LOWER,
+    RESULT_KEY_MEAN_CI_UPPER,
+    RESULT_KEY_FIRST_QUANTILE,
+    RESULT_KEY_THIRD_QUANTILE,
+    RESULT_KEY_P90,
+    RESULT_KEY_P99,
+    RESULT_KEY_P999,
+    RESULT_KEY_MAD,
+    RESULT_KEY_TRIMMED_MEAN,
+    RESULT_KEY_OUTLIERS,
+    RESULT_KEY_SAMPLES,
+    RESULT_KEY_IGNORED,
+    RESULT_KEY_MIN_NS,
+    RESULT_KEY_MEDIAN_NS,
+    RESULT_KEY_MEAN_NS,
+    RESULT_KEY_RAW_RESULTS,
+    N_RESULT_KEYS
+} result_key_t;
+
+/* the key of each column in the output */
+extern const char *const result_keys[N_RESULT_KEYS];
+
+/* start the top level array */
+void json_writer_start(json_writer_t *writer, FILE *file, size_t flags);
+/* close the top level array */
+void json_writer_finish(json_writer_t *writer);
+/*
+ * Set the frequency of the cycle counter. Results measured in cycles that are written after this
+ * gain "Min (ns)", "Median (ns)" and "Mean (ns)" columns.
+ */
+void json_writer_set_frequency(json_writer_t *writer, uint64_t frequency);
+
+/*
+ * Write the metadata of the run as the next element of the top level array,
+ * {"Metadata": {"Cycle counter frequency (Hz)": frequency}}, and set the writer's frequency.
+ */
+void json_write_metadata(json_writer_t *writer, uint64_t frequency);
+
+/* write a result set as the next element of the top level array */
+void json_write_result_set(json_writer_t *writer, result_set_t set);
+/* write a set of averaged counter results as the next element of the top level array */
+void json_write_average_counters(json_writer_t *writer, char *name,
+                                 result_t counters[NUM_AVERAGE_EVENTS]);
+/*
+ * Write results measured in each cache state (see cold_cache.h) as the next element of the top
+ * level array, with a "Cache" column when there is more than one state.
+ */
+void json_write_cache_states(json_writer_t *writer, char *name, result_t results[N_CACHE_STATES]);
+/*
+ * Write results measured at each level of memory interference (see interference.h) as the next
+ * element of the top level array, with "Interferers" and "Pattern" columns.
+ */
+void json_write_interference(json_writer_t *writer, char *name,
+                             result_t results[N_INTERFERENCE_LEVELS]);
+/*
+ * Write a record of a benchmark that failed as the next element of the top level array, in place
+ * of its results: {"Benchmark": name, "Error": error, "Exit code": exit_code}.
+ */
+void json_write_error(json_writer_t *writer, const char *name, const char *error, int exit_code);
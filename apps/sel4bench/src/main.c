@@ -17,6 +17,7 @@
 #include <allocman/bootstrap.h>
 #include <allocman/vka.h>
 #include <assert.h>
+#include <inttypes.h>
 
 #include <simple/simple.h>
 #include <simple-default/simple-default.h>
@@ -30,6 +31,7 @@
 #include <sel4utils/api.h>
 #include <sel4utils/stack.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <utils/util.h>
 #include <vka/object.h>
@@ -39,9 +41,14 @@
 #include <benchmark_types.h>
 
 #include "benchmark.h"
+#include "calibration.h"
+#include "config_file.h"
 #include "env.h"
+#include "json.h"
 #include "printing.h"
 #include "processing.h"
+#include "raw_encoding.h"
+#include "watchdog.h"
 
 /* dimensions of virtual memory for the allocator to use */
 #define ALLOCATOR_VIRTUAL_POOL_SIZE ((1 << seL4_PageBits) * 200)
@@ -56,6 +63,9 @@ static sel4utils_alloc_data_t data;
 /* environment for the benchmark runner, set up in main() */
 static env_t global_env;
 
+/* returned by run_benchmark() when the watchdog stops a benchmark */
+#define BENCHMARK_TIMED_OUT (-1)
+
 static void setup_fault_handler(env_t *env)
 {
     int error;
@@ -99,6 +109,38 @@ static void setup_fault_handler(env_t *env)
     }
 }
 
+/*
+ * Set up the io ops and notification that the driver uses the platform timer with, for
+ * calibration and the watchdog. The notification is bound to the driver's thread.
+ */
+static void init_timer_objects(env_t *env)
+{
+    if (!config_set(CONFIG_CALIBRATE_CYCLE_COUNTER) && !watchdog_needs_timer()) {
+        return;
+    }
+
+    int error = sel4platsupport_new_io_ops(env->vspace, env->vka, &env->ops);
+    ZF_LOGF_IF(error, "Failed to get io ops for the timer");
+
+    error = vka_alloc_notification(&env->vka, &env->timer_ntfn);
+    ZF_LOGF_IF(error, "Failed to allocate notification for the timer");
+
+    error = seL4_TCB_BindNotification(simple_get_tcb(&env->simple), env->timer_ntfn.cptr);
+    ZF_LOGF_IF(error, "Failed to bind timer notification");
+}
+
+/* once the cycle counter is calibrated, stop the timer's signals reaching the driver if there is no
+ * watchdog to take them, as they would be received in place of messages from the benchmarks */
+static void release_timer_objects(env_t *env)
+{
+    if (watchdog_needs_timer() || env->timer_ntfn.cptr == seL4_CapNull) {
+        return;
+    }
+
+    int error = seL4_TCB_UnbindNotification(simple_get_tcb(&env->simple));
+    ZF_LOGF_IF(error, "Failed to unbind timer notification");
+}
+
 int run_benchmark(env_t *env, benchmark_t *benchmark, void *local_results_vaddr, benchmark_args_t *args)
 {
     int error;
@@ -148,6 +190,7 @@ int run_benchmark(env_t *env, benchmark_t *benchmark, void *local_results_vaddr,
                                                seL4_PageBits, seL4_AllRights, true);
     args->untyped_size_bits = env->untyped.size_bits;
     args->nr_cores = simple_get_core_count(&env->simple);
+    memcpy(args->config, benchmark->config, RUNTIME_CONFIG_SIZE);
 
     /* set up rpc server environment */
     error = sel4rpc_server_init(&rpc_env, &env->vka, sel4rpc_default_handler, env, &process.thread.reply,
@@ -160,13 +203,27 @@ int run_benchmark(env_t *env, benchmark_t *benchmark, void *local_results_vaddr,
     char *argv[argc];
     sel4utils_create_word_args(string_args, argv, argc, remote_args_vaddr);
     /* start process */
+    watchdog_start(env, benchmark);
     error = sel4utils_spawn_process_v(&process, &env->vka, &env->vspace, argc, argv, 1);
     ZF_LOGF_IF(error, "Failed to start benchmark process");
 
     /* wait for it to finish */
     int result = SEL4BENCH_PROTOBUF_RPC;
     while (result == SEL4BENCH_PROTOBUF_RPC) {
-        seL4_MessageInfo_t info = api_recv(process.fault_endpoint.cptr, NULL, process.thread.reply.cptr);
+        seL4_Word badge = 0;
+        seL4_MessageInfo_t info = api_recv(process.fault_endpoint.cptr, &badge, process.thread.reply.cptr);
+        if (watchdog_signalled(info)) {
+            if (watchdog_expired(env, badge)) {
+                ZF_LOGE("%s benchmark did not finish within %d seconds, stopping it", benchmark->name,
+                        CONFIG_BENCHMARK_TIMEOUT);
+                /* any other threads it started are destroyed when the untyped is revoked below */
+                seL4_TCB_Suspend(process.thread.tcb.cptr);
+                result = BENCHMARK_TIMED_OUT;
+            }
+            /* otherwise keep waiting for the benchmark */
+            continue;
+        }
+
         result = seL4_GetMR(0);
         if (seL4_MessageInfo_get_label(info) != seL4_Fault_NullFault) {
             sel4utils_print_fault_message(info, benchmark->name);
@@ -180,6 +237,8 @@ int run_benchmark(env_t *env, benchmark_t *benchmark, void *local_results_vaddr,
         }
     }
 
+    watchdog_stop(env);
+
     /* free results in target vspace (they will still be in ours) */
     vspace_unmap_pages(&process.vspace, args->results, benchmark->results_pages, seL4_PageBits, VSPACE_FREE);
     vspace_unmap_pages(&process.vspace, remote_args_vaddr, 1, seL4_PageBits, VSPACE_FREE);
@@ -196,31 +255,113 @@ int run_benchmark(env_t *env, benchmark_t *benchmark, void *local_results_vaddr,
     return result;
 }
 
-json_t *launch_benchmark(benchmark_t *benchmark, env_t *env)
+#ifdef CONFIG_ADAPTIVE_SAMPLING
+#define MAX_LAUNCHES CONFIG_ADAPTIVE_SAMPLING_MAX_LAUNCHES
+#define LAUNCH_TIME_BUDGET_NS ((uint64_t) CONFIG_ADAPTIVE_SAMPLING_TIME_BUDGET * NS_IN_S)
+#else
+#define MAX_LAUNCHES 1
+#define LAUNCH_TIME_BUDGET_NS 0
+#endif
+
+/* check whether a benchmark has been relaunched for longer than AdaptiveSamplingTimeBudget */
+static bool out_of_time(env_t *env, bool timed, uint64_t start)
 {
-    printf("\n%s Benchmarks\n==============\n\n", benchmark->name);
+    uint64_t now;
+    if (!timed || LAUNCH_TIME_BUDGET_NS == 0 || watchdog_get_time(env, &now) != 0) {
+        return false;
+    }
 
-    /* reserve memory for the results */
-    void *results = vspace_new_pages(&env->vspace, seL4_AllRights, benchmark->results_pages, seL4_PageBits);
-    ZF_LOGF_IF(results == NULL, "Failed to allocate pages for results");
+    return now - start >= LAUNCH_TIME_BUDGET_NS;
+}
+
+/*
+ * Check whether the results of the launches so far are good enough to stop.
+ *
+ * The benchmark processes a copy of the results, with output discarded, so that the real
+ * results are left untouched for when they are output.
+ */
+static bool results_converged(benchmark_t *benchmark, size_t n_launches, void *results[n_launches])
+{
+#ifdef CONFIG_ADAPTIVE_SAMPLING
+    size_t size = benchmark->results_pages * BIT(seL4_PageBits);
+    void *copy = malloc(size);
+    ZF_LOGF_IF(copy == NULL, "Failed to allocate memory to check results");
+    memcpy(copy, results[0], size);
+
+    json_writer_t discard;
+    json_writer_start(&discard, NULL, 0);
+    processing_start_runs(copy, size, n_launches - 1, &results[1],
+                          CONFIG_ADAPTIVE_SAMPLING_CI_WIDTH / 100.0);
+    int error = benchmark->process(copy, &discard);
+    bool converged = processing_finish_runs();
+    free(copy);
+
+    return error == 0 && converged;
+#else
+    return true;
+#endif
+}
+
+int launch_benchmark(benchmark_t *benchmark, env_t *env, json_writer_t *writer)
+{
+    /* unless framing, anything else printed to the console ends up in the middle of the json */
+    if (config_set(CONFIG_FRAMED_JSON_OUTPUT)) {
+        printf("\n%s Benchmarks\n==============\n\n", benchmark->name);
+    }
 
     /* reserve memory for args */
     assert(sizeof(benchmark_args_t) < PAGE_SIZE_4K);
     void *args = vspace_new_pages(&env->vspace, seL4_AllRights, 1, seL4_PageBits);
-    /* Run benchmark process */
-    int exit_code = run_benchmark(env, benchmark, results, args);
 
-    /* process & print results */
-    json_t *json = NULL;
+    /* Run the benchmark process until the results are good enough, or the time budget is spent.
+     * Without adaptive sampling there is exactly one launch. Benchmarks that use the timer
+     * themselves are only limited by the number of launches. */
+    void *results[MAX_LAUNCHES];
+    size_t n_launches = 0;
+    int exit_code = EXIT_SUCCESS;
+    uint64_t start = 0;
+    bool timed = !benchmark->uses_timer && watchdog_get_time(env, &start) == 0;
+    while (n_launches < MAX_LAUNCHES) {
+        /* reserve memory for the results */
+        results[n_launches] = vspace_new_pages(&env->vspace, seL4_AllRights, benchmark->results_pages,
+                                               seL4_PageBits);
+        ZF_LOGF_IF(results[n_launches] == NULL, "Failed to allocate pages for results");
+
+        exit_code = run_benchmark(env, benchmark, results[n_launches], args);
+        n_launches++;
+        if (exit_code != EXIT_SUCCESS || n_launches == MAX_LAUNCHES ||
+            results_converged(benchmark, n_launches, results) || out_of_time(env, timed, start)) {
+            break;
+        }
+    }
+
+    if (config_set(CONFIG_ADAPTIVE_SAMPLING) && exit_code == EXIT_SUCCESS) {
+        ZF_LOGI("%s benchmark launched %zu times", benchmark->name, n_launches);
+    }
+
+    /* process & write out results, or a record of the failure in their place */
+    int error = exit_code;
     if (exit_code == EXIT_SUCCESS) {
-        json = benchmark->process(results);
+        processing_start_runs(results[0], benchmark->results_pages * BIT(seL4_PageBits),
+                              n_launches - 1, &results[1], 0);
+        error = benchmark->process(results[0], writer);
+        processing_finish_runs();
+        if (error != 0) {
+            json_write_error(writer, benchmark->name, "Failed to process results", error);
+        }
+    } else if (exit_code == BENCHMARK_TIMED_OUT) {
+        json_write_error(writer, benchmark->name, "Benchmark timed out", exit_code);
+    } else {
+        json_write_error(writer, benchmark->name, "Benchmark process failed", exit_code);
     }
 
     /* free results */
-    vspace_unmap_pages(&env->vspace, results, benchmark->results_pages, seL4_PageBits, VSPACE_FREE);
+    for (size_t i = 0; i < n_launches; i++) {
+        vspace_unmap_pages(&env->vspace, results[i], benchmark->results_pages, seL4_PageBits, VSPACE_FREE);
+    }
     vspace_unmap_pages(&env->vspace, args, 1, seL4_PageBits, VSPACE_FREE);
 
-    return json;
+    return error;
 }
 
 void find_untyped(vka_t *vka, vka_object_t *untyped)
@@ -237,10 +378,81 @@ void find_untyped(vka_t *vka, vka_object_t *untyped)
     ZF_LOGF_IF(error, "Failed to find free untyped\n");
 }
 
+/* output of a benchmark that is buffered so it can be printed in one piece */
+typedef struct output_buffer {
+    FILE *file;
+    char *data;
+    size_t size;
+} output_buffer_t;
+
+/*
+ * Start collecting the json output of the next benchmark, into a buffer unless it is being
+ * streamed straight to the console. When framing, each benchmark gets a top level array of its
+ * own, otherwise its elements are added to the array of the whole run.
+ *
+ * @param frequency frequency of the cycle counter, or 0 if it is unknown.
+ */
+static void start_output(json_writer_t *writer, output_buffer_t *buffer, uint64_t frequency)
+{
+    buffer->file = stdout;
+    if (!config_set(CONFIG_STREAM_JSON_OUTPUT)) {
+        buffer->file = open_memstream(&buffer->data, &buffer->size);
+        ZF_LOGF_IF(buffer->file == NULL, "Failed to create buffer for output");
+    }
+
+    if (config_set(CONFIG_FRAMED_JSON_OUTPUT)) {
+        json_writer_start(writer, buffer->file, JSON_PRESERVE_ORDER | JSON_INDENT(CONFIG_JSON_INDENT));
+        json_writer_set_frequency(writer, frequency);
+    } else {
+        writer->file = buffer->file;
+    }
+}
+
+/*
+ * Print the output of a single benchmark as a chunk that can be checked and parsed on its own:
+ *
+ *   JSON CHUNK <benchmark> <length in bytes> <crc32 of the json, in hex>
+ *   <json>
+ *   END JSON CHUNK
+ */
+static void print_chunk(const char *name, const char *buffer, size_t size)
+{
+    uint32_t crc = raw_encoding_crc32(0, (const uint8_t *) buffer, size);
+    printf("JSON CHUNK %s %zu %08"PRIx32"\n", name, size, crc);
+    fwrite(buffer, 1, size, stdout);
+    printf("\nEND JSON CHUNK\n");
+    fflush(stdout);
+}
+
+/* print the output of a benchmark collected since start_output() */
+static void finish_output(json_writer_t *writer, output_buffer_t *buffer, const char *name)
+{
+    if (config_set(CONFIG_FRAMED_JSON_OUTPUT)) {
+        json_writer_finish(writer);
+    }
+
+    if (buffer->file != stdout) {
+        fclose(buffer->file);
+        if (config_set(CONFIG_FRAMED_JSON_OUTPUT)) {
+            print_chunk(name, buffer->data, buffer->size);
+        } else {
+            fwrite(buffer->data, 1, buffer->size, stdout);
+        }
+        free(buffer->data);
+    }
+    writer->file = stdout;
+    fflush(stdout);
+}
+
 void *main_continued(void *arg)
 {
 
     setup_fault_handler(&global_env);
+    init_timer_objects(&global_env);
+    /* calibrate before the watchdog holds the timer */
+    uint64_t frequency = calibrate_cycle_counter(&global_env);
+    release_timer_objects(&global_env);
+    watchdog_init(&global_env);
 
     /* find an untyped for the process to use */
     find_untyped(&global_env.vka, &global_env.untyped);
@@ -264,26 +476,59 @@ void *main_continued(void *arg)
         NULL
     };
 
-    json_t *output = json_array();
-    assert(output != NULL);
-    int error;
+    /* override which benchmarks run, and how, from the cpio archive */
+    config_file_apply(benchmarks);
+
+    /*
+     * Results are serialised as each benchmark finishes, and printed as soon as it has finished,
+     * so only one benchmark's results are held at a time. With FramedJsonOutput, each benchmark's
+     * results are printed as a chunk of their own. Otherwise they make up a single array between
+     * JSON OUTPUT and END JSON OUTPUT, which is printed a benchmark at a time, or as it is written
+     * with StreamJsonOutput. Benchmark banners are left out of the array, but other console output
+     * printed while a benchmark runs, such as log messages, ends up in it.
+     */
+    json_writer_t writer;
+    output_buffer_t buffer;
+    if (!config_set(CONFIG_FRAMED_JSON_OUTPUT)) {
+        printf("JSON OUTPUT\n");
+        json_writer_start(&writer, stdout, JSON_PRESERVE_ORDER | JSON_INDENT(CONFIG_JSON_INDENT));
+        json_writer_set_frequency(&writer, frequency);
+    }
+
+    /* the metadata comes first, as a chunk of its own when framing */
+    if (frequency != 0) {
+        start_output(&writer, &buffer, frequency);
+        json_write_metadata(&writer, frequency);
+        finish_output(&writer, &buffer, "metadata");
+    }
 
-    /* run the benchmarks */
+    /* run the benchmarks, a benchmark that fails is recorded in the output in place of its
+     * results, and the rest still run */
+    int failures = 0;
     for (int i = 0; benchmarks[i] != NULL; i++) {
-        if (benchmarks[i]->enabled) {
-            json_t *result = launch_benchmark(benchmarks[i], &global_env);
-            ZF_LOGF_IF(result == NULL, "Failed to run benchmark %s", benchmarks[i]->name);
-            error = json_array_extend(output, result);
-            ZF_LOGF_IF(error != 0, "Failed to add benchmark results");
+        if (!benchmarks[i]->enabled) {
+            continue;
         }
+
+        start_output(&writer, &buffer, frequency);
+        int error = launch_benchmark(benchmarks[i], &global_env, &writer);
+        if (error != 0) {
+            ZF_LOGE("Failed to run benchmark %s", benchmarks[i]->name);
+            failures++;
+        }
+        finish_output(&writer, &buffer, benchmarks[i]->name);
     }
 
-    printf("JSON OUTPUT\n");
-    error = json_dumpf(output, stdout, JSON_PRESERVE_ORDER | JSON_INDENT(CONFIG_JSON_INDENT));
-    ZF_LOGF_IF(error, "Failed to dump output");
+    if (!config_set(CONFIG_FRAMED_JSON_OUTPUT)) {
+        json_writer_finish(&writer);
+        printf("END JSON OUTPUT\n");
+    }
 
-    printf("END JSON OUTPUT\n");
-    printf("All is well in the universe.\n");
+    if (failures == 0) {
+        printf("All is well in the universe.\n");
+    } else {
+        printf("%d benchmarks failed.\n", failures);
+    }
     printf("\n\nFin\n");
 
     return 0;
@@ -15,46 +15,134 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "benchmark.h"
+#include <sel4benchapp/gen_config.h>
+#include <utils/util.h>
+
 #include "math.h"
+#include "results.h"
 
-/* these functions adapted from libgsl -- require code to be GPL */
-static double
-results_mean(const size_t n, const ccnt_t array[n])
+/* bits sorted by each pass of the radix sort */
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+typedef struct {
+    ccnt_t min;
+    ccnt_t max;
+    double mean;
+    double variance;
+} moments_t;
+
+/*
+ * Calculate min, max, mean and variance in a single pass using Welford's algorithm, which
+ * does not lose precision the way summing squares does for large sample counts.
+ */
+static moments_t
+results_moments(const size_t n, const ccnt_t array[n])
 {
-    size_t i;
     long double mean = 0;
-    /* Compute the arithmetic mean of a dataset using the recurrence relation
-     * mean_(n) = mean(n-1) + (data[n] - mean(n-1))/(n+1)   */
+    long double m2 = 0;
+    moments_t moments = {
+        .min = array[0],
+        .max = array[0],
+    };
 
-    for (i = 0; i < n; i++) {
-        mean += (array[i] - mean) / (i + 1);
+    for (size_t i = 0; i < n; i++) {
+        const long double delta = (long double) array[i] - mean;
+        mean += delta / (i + 1);
+        m2 += delta * ((long double) array[i] - mean);
+        moments.min = MIN(moments.min, array[i]);
+        moments.max = MAX(moments.max, array[i]);
     }
-    return mean;
+
+    moments.mean = mean;
+    moments.variance = m2 / n;
+    return moments;
 }
 
 static double
-results_variance(const size_t n, const ccnt_t array[n], const ccnt_t mean)
+results_stddev(const size_t n, const long double variance)
+{
+    return sqrt ( variance * ((double) n / (double) (n - 1.0f)));
+}
+
+/*
+ * LSD radix sort of data into sorted, using scratch as a temporary buffer. Each pass sorts on
+ * RADIX_BITS of the value, and passes above the highest set bit of max are skipped, so small cycle
+ * counts only take a couple of passes over the data.
+ */
+static void
+results_sort(const size_t n, const ccnt_t data[n], ccnt_t max, ccnt_t sorted[n], ccnt_t scratch[n])
 {
-    long double variance = 0;
+    const ccnt_t *src = data;
+    ccnt_t *dest = scratch;
+    size_t counts[RADIX_BUCKETS];
+    int passes = 0;
+
+    /* make sure the last pass writes to sorted */
+    for (ccnt_t remaining = max; remaining != 0; remaining >>= RADIX_BITS) {
+        passes++;
+    }
+    if (passes % 2 == 1) {
+        dest = sorted;
+    }
+
+    if (passes == 0) {
+        /* everything is 0 */
+        memcpy(sorted, data, n * sizeof(ccnt_t));
+        return;
+    }
+
+    for (int pass = 0; pass < passes; pass++) {
+        const int shift = pass * RADIX_BITS;
+
+        memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) {
+            counts[(src[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+
+        /* convert counts to starting offsets */
+        size_t offset = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            size_t count = counts[bucket];
+            counts[bucket] = offset;
+            offset += count;
+        }
 
-    size_t i;
+        for (size_t i = 0; i < n; i++) {
+            dest[counts[(src[i] >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+        }
 
-    /* find the sum of the squares */
-    for (i = 0; i < n; i++) {
-        const long double delta = (long double) array[i] - (long double) mean;
-        variance += (delta * delta - variance) / (i + 1);
+        src = dest;
+        dest = (dest == sorted) ? scratch : sorted;
     }
 
-    return (double) variance;
+    assert(src == sorted);
 }
 
-static double
-results_stddev(const size_t n, const ccnt_t array[n], const long double variance)
+static ccnt_t
+results_max(const size_t n, const ccnt_t data[n])
 {
-    return sqrt ( variance * ((double) n / (double) (n - 1.0f)));
+    ccnt_t max = 0;
+    for (size_t i = 0; i < n; i++) {
+        max = MAX(max, data[i]);
+    }
+    return max;
 }
 
+/*
+ * Sort a copy of data, none of which is larger than max, into the first n elements of a new
+ * buffer, which the caller must free. The buffer is on the heap as there can be a lot of data.
+ */
+static ccnt_t *
+results_sort_copy(const size_t n, const ccnt_t data[n], ccnt_t max)
+{
+    ccnt_t *sorted_data = malloc(2 * n * sizeof(ccnt_t));
+    ZF_LOGF_IF(sorted_data == NULL, "Failed to allocate memory to sort %zu results", n);
+    results_sort(n, data, max, sorted_data, &sorted_data[n]);
+    return sorted_data;
+}
+
+/* these functions adapted from libgsl -- require code to be GPL */
 static double
 results_median(const size_t n, const ccnt_t sorted_data[n])
 {
@@ -126,45 +214,487 @@ results_mode(const size_t n, const ccnt_t sorted_data[n])
         }
     }
 
-    if (mode_freq == 0) {
-        mode_freq = current_freq;
+    if (current_freq > mode_freq) {
+        mode = current_value;
     }
 
     return mode;
 }
 
+/* proportion of samples discarded from each end for the trimmed mean */
+#define TRIM_PROPORTION 0.1
+/* samples further than this many interquartile ranges outside the quartiles are outliers */
+#define OUTLIER_IQR_FENCE 1.5
+
+/*
+ * Median absolute deviation from the median. The deviations of the samples below the median
+ * increase going down from the median, and those above increase going up, so the two sorted
+ * sequences of deviations are merged outwards from the median until the middle one is reached.
+ */
+static double
+results_mad(const size_t n, const ccnt_t sorted_data[n], const double median)
+{
+    /* first sample at or above the median */
+    size_t split = n / 2;
+    while (split > 0 && sorted_data[split - 1] >= median) {
+        split--;
+    }
+
+    const size_t lhs = (n - 1) / 2;
+    const size_t rhs = n / 2;
+    size_t below = split;
+    size_t above = split;
+    double lhs_deviation = 0;
+    double deviation = 0;
+
+    for (size_t i = 0; i <= rhs; i++) {
+        if (above == n || (below > 0 && median - sorted_data[below - 1] < sorted_data[above] - median)) {
+            deviation = median - sorted_data[--below];
+        } else {
+            deviation = sorted_data[above++] - median;
+        }
+        if (i == lhs) {
+            lhs_deviation = deviation;
+        }
+    }
+
+    return (lhs_deviation + deviation) / 2.0;
+}
+
+static double
+results_trimmed_mean(const size_t n, const ccnt_t sorted_data[n])
+{
+    const size_t trim = n * TRIM_PROPORTION;
+    long double mean = 0;
+
+    for (size_t i = trim; i < n - trim; i++) {
+        mean += (sorted_data[i] - mean) / (i - trim + 1);
+    }
+
+    return mean;
+}
+
+static size_t
+results_outliers(const size_t n, const ccnt_t sorted_data[n], const double first_quantile,
+                 const double third_quantile)
+{
+    const double fence = OUTLIER_IQR_FENCE * (third_quantile - first_quantile);
+    size_t outliers = 0;
+
+    for (size_t i = 0; i < n && sorted_data[i] < first_quantile - fence; i++) {
+        outliers++;
+    }
+    for (size_t i = n; i > 0 && sorted_data[i - 1] > third_quantile + fence; i--) {
+        outliers++;
+    }
+
+    return outliers;
+}
+
+/* fixed seed, so the same samples always give the same confidence intervals */
+#define BOOTSTRAP_SEED 0x5e14be9c4ULL
+/* normal quantile for a 95% confidence interval */
+#define CI_Z 1.96
+
+/* splitmix64 */
+static uint64_t
+bootstrap_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* rearrange indices so that indices[k] is the kth smallest, with smaller ones before it */
+static void
+select_index(size_t n, uint32_t indices[n], size_t k)
+{
+    size_t left = 0;
+    size_t right = n - 1;
+
+    while (left < right) {
+        uint32_t pivot = indices[left + (right - left) / 2];
+        size_t i = left;
+        size_t j = right;
+        while (i <= j) {
+            while (indices[i] < pivot) {
+                i++;
+            }
+            while (indices[j] > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                uint32_t tmp = indices[i];
+                indices[i] = indices[j];
+                indices[j] = tmp;
+                i++;
+                if (j == 0) {
+                    break;
+                }
+                j--;
+            }
+        }
+        if (k <= j) {
+            right = j;
+        } else if (k >= i) {
+            left = i;
+        } else {
+            return;
+        }
+    }
+}
+
 static int
-ccnt_compare_fn(const void *a, const void *b)
+double_compare_fn(const void *a, const void *b)
 {
-    ccnt_t first = *((ccnt_t *) a);
-    ccnt_t second = *((ccnt_t *) b);
+    double first = *((double *) a);
+    double second = *((double *) b);
 
     return (first > second) - (first < second);
 }
 
+/* 2.5th and 97.5th percentiles of the bootstrap estimates */
+static void
+bootstrap_interval(size_t n, double estimates[n], double *lower, double *upper)
+{
+    qsort(estimates, n, sizeof(double), double_compare_fn);
+    *lower = estimates[(size_t)(0.025 * (n - 1))];
+    *upper = estimates[(size_t)ceil(0.975 * (n - 1))];
+}
+
+/*
+ * 95% confidence intervals of the mean and median by bootstrap resampling.
+ *
+ * Each resample draws n indices into the sorted data with replacement. As the data is sorted, the
+ * median of a resample is at the median of its indices, which is found by selection rather than
+ * sorting the resample.
+ */
+static void
+results_bootstrap(const size_t n, const ccnt_t sorted_data[n], result_t *result)
+{
+    const size_t resamples = CONFIG_BOOTSTRAP_RESAMPLES;
+
+    if (resamples == 0 || n > UINT32_MAX) {
+        result->mean_ci_lower = result->mean_ci_upper = NAN;
+        result->median_ci_lower = result->median_ci_upper = NAN;
+        return;
+    }
+
+    uint32_t *indices = malloc(n * sizeof(uint32_t));
+    double *means = malloc(resamples * sizeof(double));
+    double *medians = malloc(resamples * sizeof(double));
+    ZF_LOGF_IF(indices == NULL || means == NULL || medians == NULL,
+               "Failed to allocate memory to bootstrap %zu results", n);
+
+    uint64_t state = BOOTSTRAP_SEED;
+    for (size_t r = 0; r < resamples; r++) {
+        long double sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            indices[i] = ((bootstrap_random(&state) >> 32) * n) >> 32;
+            sum += sorted_data[indices[i]];
+        }
+        means[r] = sum / n;
+
+        select_index(n, indices, n / 2);
+        medians[r] = sorted_data[indices[n / 2]];
+        if (n % 2 == 0) {
+            /* the other middle index is the largest of those before it */
+            uint32_t lhs = indices[0];
+            for (size_t i = 1; i < n / 2; i++) {
+                lhs = MAX(lhs, indices[i]);
+            }
+            medians[r] = (medians[r] + sorted_data[lhs]) / 2.0;
+        }
+    }
+
+    bootstrap_interval(resamples, means, &result->mean_ci_lower, &result->mean_ci_upper);
+    bootstrap_interval(resamples, medians, &result->median_ci_lower, &result->median_ci_upper);
+
+    free(medians);
+    free(means);
+    free(indices);
+}
+
 result_t
 calculate_results(const size_t n, ccnt_t data[n])
 {
-    /* create a copy of the data to sort */
-    ccnt_t sorted_data[n];
-    memcpy(sorted_data, data, n * sizeof(ccnt_t));
+    result_t result = {
+        .raw_data = data,
+        .samples = n,
+    };
+
+    if (n == 0) {
+        return result;
+    }
 
-    /* sort the data */
-    qsort(sorted_data, n, sizeof(ccnt_t), ccnt_compare_fn);
+    moments_t moments = results_moments(n, data);
 
-    result_t result;
-    result.min = sorted_data[0];
-    result.max = sorted_data[n - 1];
+    ccnt_t *sorted_data = results_sort_copy(n, data, moments.max);
+
+    result.min = moments.min;
+    result.max = moments.max;
     assert(result.min <= result.max);
-    result.mean = results_mean(n, sorted_data);
-    result.variance = results_variance(n, sorted_data, result.mean);
-    result.stddev = results_stddev(n, sorted_data, result.variance);
+    assert(sorted_data[0] == result.min && sorted_data[n - 1] == result.max);
+    result.mean = moments.mean;
+    result.variance = moments.variance;
+    result.stddev = results_stddev(n, result.variance);
     result.median = results_median(n, sorted_data);
     result.first_quantile = results_quantile(n, sorted_data, 0.25f);
     result.third_quantile = results_quantile(n, sorted_data, 0.75f);
+    result.p90 = results_quantile(n, sorted_data, 0.90);
+    result.p99 = results_quantile(n, sorted_data, 0.99);
+    result.p999 = results_quantile(n, sorted_data, 0.999);
     result.mode = results_mode(n, sorted_data);
-    result.raw_data = data;
-    result.samples = n;
+    result.mad = results_mad(n, sorted_data, result.median);
+    result.trimmed_mean = results_trimmed_mean(n, sorted_data);
+    result.outliers = results_outliers(n, sorted_data, result.first_quantile, result.third_quantile);
+    results_bootstrap(n, sorted_data, &result);
 
+    free(sorted_data);
     return result;
 }
+
+/* representative value for the values counted in a histogram bucket */
+static double
+histogram_value(const histogram_t *histogram, uint32_t bucket)
+{
+    double lowest = MAX(histogram_bucket_lowest(bucket), histogram->min);
+    double highest = MIN(histogram_bucket_highest(bucket), histogram->max);
+    return (lowest + highest) / 2.0;
+}
+
+static double
+histogram_quantile(const histogram_t *histogram, const double quantile)
+{
+    /* find the bucket holding the value with the same rank results_quantile() would use */
+    const uint64_t rank = quantile * (histogram->count - 1);
+    uint64_t seen = 0;
+
+    for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        seen += histogram->counts[bucket];
+        if (seen > rank) {
+            return histogram_value(histogram, bucket);
+        }
+    }
+
+    return histogram->max;
+}
+
+/* number of samples within distance of value */
+static uint64_t
+histogram_count_within(const histogram_t *histogram, const double value, const double distance)
+{
+    uint64_t count = 0;
+    for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        if (histogram->counts[bucket] > 0 && fabs(histogram_value(histogram, bucket) - value) <= distance) {
+            count += histogram->counts[bucket];
+        }
+    }
+    return count;
+}
+
+/*
+ * Find the median absolute deviation by bisecting on the deviation. The count is a step function
+ * of the deviation, so this converges on the deviation of one of the bucket values.
+ */
+static double
+histogram_mad(const histogram_t *histogram, const double median)
+{
+    double low = 0;
+    double high = MAX(median - histogram->min, histogram->max - median);
+
+    for (int i = 0; i < 64; i++) {
+        double mid = (low + high) / 2;
+        if (histogram_count_within(histogram, median, mid) * 2 > histogram->count) {
+            high = mid;
+        } else {
+            low = mid;
+        }
+    }
+
+    return high;
+}
+
+/* samples are recorded with the overhead included, so it can be larger than some of them */
+static double
+less_overhead(double value, ccnt_t overhead)
+{
+    return MAX(0, value - overhead);
+}
+
+result_t
+calculate_histogram_results(const histogram_t *histogram, ccnt_t overhead)
+{
+    result_t result = {
+        .samples = histogram->count,
+        .raw_data = NULL,
+    };
+
+    if (histogram->count == 0) {
+        return result;
+    }
+
+    /* values are recorded before the overhead is subtracted, so work out the statistics first
+     * then shift them all down by the overhead */
+    long double mean = (long double) histogram->sum / histogram->count;
+    long double m2 = 0;
+    uint32_t mode_bucket = 0;
+    for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        if (histogram->counts[bucket] > 0) {
+            const long double delta = histogram_value(histogram, bucket) - mean;
+            m2 += histogram->counts[bucket] * delta * delta;
+        }
+        if (histogram->counts[bucket] > histogram->counts[mode_bucket]) {
+            mode_bucket = bucket;
+        }
+    }
+
+    result.min = less_overhead(histogram->min, overhead);
+    result.max = less_overhead(histogram->max, overhead);
+    result.mean = less_overhead(mean, overhead);
+    result.variance = m2 / histogram->count;
+    result.stddev = results_stddev(histogram->count, result.variance);
+    result.mode = less_overhead(histogram_value(histogram, mode_bucket), overhead);
+    result.median = less_overhead(histogram_quantile(histogram, 0.5), overhead);
+    result.first_quantile = less_overhead(histogram_quantile(histogram, 0.25), overhead);
+    result.third_quantile = less_overhead(histogram_quantile(histogram, 0.75), overhead);
+    result.p90 = less_overhead(histogram_quantile(histogram, 0.90), overhead);
+    result.p99 = less_overhead(histogram_quantile(histogram, 0.99), overhead);
+    result.p999 = less_overhead(histogram_quantile(histogram, 0.999), overhead);
+    result.mad = histogram_mad(histogram, histogram_quantile(histogram, 0.5));
+
+    /* there are no samples to resample, so use the order statistics of the median and the
+     * normal approximation for the mean instead. A single sample has a zero width interval. */
+    if (histogram->count < 2) {
+        result.median_ci_lower = result.median_ci_upper = result.median;
+    } else {
+        const double spread = CI_Z * sqrt(histogram->count) / 2.0;
+        const double lower_rank = MAX(0, floor(histogram->count / 2.0 - spread));
+        const double upper_rank = MIN(histogram->count - 1, ceil(histogram->count / 2.0 + spread));
+        result.median_ci_lower = less_overhead(histogram_quantile(histogram, lower_rank / (histogram->count - 1)),
+                                               overhead);
+        result.median_ci_upper = less_overhead(histogram_quantile(histogram, upper_rank / (histogram->count - 1)),
+                                               overhead);
+    }
+    result.mean_ci_lower = result.mean - CI_Z * result.stddev / sqrt(histogram->count);
+    result.mean_ci_upper = result.mean + CI_Z * result.stddev / sqrt(histogram->count);
+
+    /* trimmed mean and outliers from the representative values of the buckets */
+    const uint64_t trim = histogram->count * TRIM_PROPORTION;
+    const double fence = OUTLIER_IQR_FENCE * (result.third_quantile - result.first_quantile);
+    long double trimmed_sum = 0;
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        uint64_t count = histogram->counts[bucket];
+        if (count == 0) {
+            continue;
+        }
+        double value = less_overhead(histogram_value(histogram, bucket), overhead);
+
+        /* the part of this bucket that is not in either trimmed tail */
+        uint64_t start = MAX(seen, trim);
+        uint64_t end = MIN(seen + count, histogram->count - trim);
+        if (end > start) {
+            trimmed_sum += (long double) value * (end - start);
+        }
+        seen += count;
+
+        if (value < result.first_quantile - fence || value > result.third_quantile + fence) {
+            result.outliers += count;
+        }
+    }
+    result.trimmed_mean = trimmed_sum / (histogram->count - 2 * trim);
+
+    return result;
+}
+
+double
+calculate_median_ci_width(const size_t n, const ccnt_t data[n])
+{
+    /* normal approximation to the binomial distribution of the rank of the median */
+    const double z = 1.96;
+    const double spread = z * sqrt(n) / 2.0;
+    const long lower = floor(n / 2.0 - spread);
+    const long upper = ceil(1 + n / 2.0 + spread);
+
+    /* ranks are 1 based */
+    if (n == 0 || lower < 1 || (size_t) upper > n) {
+        return INFINITY;
+    }
+
+    ccnt_t *sorted_data = results_sort_copy(n, data, results_max(n, data));
+
+    double median = results_median(n, sorted_data);
+    double width = sorted_data[upper - 1] - sorted_data[lower - 1];
+    free(sorted_data);
+
+    if (width == 0) {
+        return 0;
+    }
+    return median == 0 ? INFINITY : width / median;
+}
+
+mann_whitney_t
+calculate_mann_whitney(const size_t n_a, const ccnt_t a[n_a], const size_t n_b, const ccnt_t b[n_b])
+{
+    mann_whitney_t test = {
+        .u = NAN,
+        .z = NAN,
+        .p = NAN,
+        .rank_biserial = NAN,
+    };
+
+    if (n_a == 0 || n_b == 0) {
+        return test;
+    }
+
+    ccnt_t *sorted_a = results_sort_copy(n_a, a, results_max(n_a, a));
+    ccnt_t *sorted_b = results_sort_copy(n_b, b, results_max(n_b, b));
+
+    /* merge the two samples, giving each group of tied values the average of their ranks */
+    const double n = n_a + n_b;
+    double rank_sum_b = 0;
+    double ties = 0;
+    size_t i = 0, j = 0;
+    while (i < n_a || j < n_b) {
+        ccnt_t value = (j == n_b || (i < n_a && sorted_a[i] < sorted_b[j])) ? sorted_a[i] : sorted_b[j];
+        size_t count_a = 0, count_b = 0;
+        while (i < n_a && sorted_a[i] == value) {
+            i++;
+            count_a++;
+        }
+        while (j < n_b && sorted_b[j] == value) {
+            j++;
+            count_b++;
+        }
+
+        /* ranks are 1 based, the group takes the ranks after everything merged so far */
+        double t = count_a + count_b;
+        double first_rank = i + j - t + 1;
+        rank_sum_b += count_b * (first_rank + (t - 1) / 2.0);
+        ties += t * t * t - t;
+    }
+
+    free(sorted_a);
+    free(sorted_b);
+
+    const double pairs = (double) n_a * n_b;
+    test.u = rank_sum_b - n_b * (n_b + 1.0) / 2.0;
+    test.rank_biserial = 2.0 * test.u / pairs - 1.0;
+
+    /* normal approximation with tie and continuity corrections */
+    const double variance = pairs / 12.0 * ((n + 1) - ties / (n * (n - 1)));
+    const double difference = test.u - pairs / 2.0;
+    if (variance <= 0) {
+        /* every sample is identical */
+        test.z = 0;
+        test.p = 1;
+    } else {
+        const double corrected = fabs(difference) < 0.5 ? 0 : fabs(difference) - 0.5;
+        test.z = copysign(corrected / sqrt(variance), difference);
+        test.p = erfc(fabs(test.z) / sqrt(2));
+    }
+
+    return test;
+}
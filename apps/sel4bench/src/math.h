@@ -13,8 +13,32 @@
 #ifndef __SEL4BENCH_MATH_H
 #define __SEL4BENCH_MATH_H
 
-#include "benchmark.h"
+#include <histogram.h>
+#include "results.h"
+
+/* result of a Mann-Whitney U test of whether samples b tend to be larger or smaller than a */
+typedef struct {
+    /* number of pairs (one from each sample) where b is larger, counting ties as half */
+    double u;
+    /* u as a standard score, with tie and continuity corrections */
+    double z;
+    /* two sided p value, from the normal approximation */
+    double p;
+    /* effect size: the probability that b is larger minus the probability that it is smaller.
+     * -1 if every sample of b is smaller than every sample of a, 1 if every one is larger. */
+    double rank_biserial;
+} mann_whitney_t;
 
 result_t calculate_results(const size_t n, ccnt_t data[n]);
+/*
+ * Width of the distribution-free 95% confidence interval of the median of data, relative to the
+ * median. Returns INFINITY if there are too few samples to bound the median.
+ */
+double calculate_median_ci_width(const size_t n, const ccnt_t data[n]);
+/* calculate results from a histogram, after subtracting overhead from every value */
+result_t calculate_histogram_results(const histogram_t *histogram, ccnt_t overhead);
+/* compare two sets of samples with a Mann-Whitney U test, fields are NaN if either is empty */
+mann_whitney_t calculate_mann_whitney(const size_t n_a, const ccnt_t a[n_a], const size_t n_b,
+                                      const ccnt_t b[n_b]);
 
 #endif /* __SEL4BENCH_MATH_H */
@@ -21,8 +21,10 @@
 #include "printing.h"
 #include "processing.h"
 
-static json_t *
-process_mapping_results(void *r)
+static benchmark_t page_mapping_benchmark;
+
+static int
+process_mapping_results(void *r, json_writer_t *writer)
 {
     page_mapping_results_t *raw_results = r;
     ccnt_t overhead;
@@ -40,13 +42,27 @@ process_mapping_results(void *r)
 
     overhead = overhead_result.min;
 
-    int nline = TESTS * NPHASE;
+    /* only the tests selected by the runtime config were run */
+    const char *config = page_mapping_benchmark.config;
+    size_t runs = runtime_config_runs(config, RUNS);
+    int ntest = runtime_config_num_params(config, TESTS);
+    if (ntest == 0) {
+        return 0;
+    }
+    int selected[ntest];
+    for (int i = 0, t = 0; i < TESTS; i++) {
+        if (runtime_config_param_enabled(config, i)) {
+            selected[t++] = i;
+        }
+    }
+
+    int nline = ntest * NPHASE;
 
 	char *phase_col[nline];
 	json_int_t npage_col[nline];
 	for (int i = 0; i < nline; i++) {
 		phase_col[i] = phase_name[i % NPHASE];
-		npage_col[i] = page_mapping_benchmark_params[i/NPHASE].npage;
+		npage_col[i] = page_mapping_benchmark_params[selected[i/NPHASE]].npage;
 	}
 
     column_t extra_cols[] = {
@@ -62,7 +78,7 @@ process_mapping_results(void *r)
 			},
     };
 
-    result_t results[TESTS][NPHASE];
+    result_t results[ntest][NPHASE];
 
     result_set_t result_set = {
             .name = "Mapping Benchmark",
@@ -73,20 +89,19 @@ process_mapping_results(void *r)
     };
 
     /* now calculate the results */
-    for (int i = 0; i < TESTS; i++) {
+    for (int i = 0; i < ntest; i++) {
 		for (int j = 0; j < NPHASE; j++){
 	        result_desc_t desc = {
-					.name = page_mapping_benchmark_params[i].name,
+					.name = page_mapping_benchmark_params[selected[i]].name,
 					.overhead = overhead,
 	        };
 			results[i][j] =
-				process_result(RUNS,raw_results->benchmarks_result[i][j],desc);
+				process_result(runs,raw_results->benchmarks_result[selected[i]][j],desc);
 		}
     }
 
-    json_t *array = json_array();
-    json_array_append_new(array, result_set_to_json(result_set));
-    return array;
+    json_write_result_set(writer, result_set);
+    return 0;
 }
 
 static benchmark_t page_mapping_benchmark = {
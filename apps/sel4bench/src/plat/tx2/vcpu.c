@@ -29,7 +29,7 @@
  * We don't parameterize the benchmarks or anything fancy, so nothing
  * particularly amazing is done in here.
  */
-static json_t *process_vcpu_results(void *r)
+static int process_vcpu_results(void *r, json_writer_t *writer)
 {
     vcpu_benchmark_overall_results_t *raw_results = r;
     const int n_params = VCPU_BENCHMARK_N_PARAMS + 1;
@@ -96,8 +96,6 @@ static json_t *process_vcpu_results(void *r)
         .ignored = VCPU_BENCH_N_ITERATIONS_IGNORED
     };
 
-    json_t *array = json_array();
-
     for (int i = 0; i < VCPU_BENCHMARK_N_BENCHMARKS; i++) {
         /* process_result basically takes a bunch of numbers and computes
          * averages, means, deviations, etc.
@@ -106,10 +104,10 @@ static json_t *process_vcpu_results(void *r)
                                     raw_results->results[i].deep_data.elapsed,
                                     all_bms_result_desc);
 
-        json_array_append_new(array, result_set_to_json(*bm_result_sets[i]));
+        json_write_result_set(writer, *bm_result_sets[i]);
     }
 
-    return array;
+    return 0;
 }
 
 #ifdef CONFIG_APP_VCPU_BENCH
@@ -12,11 +12,8 @@
 
 #include <stdio.h>
 #include <sel4bench/sel4bench.h>
-#include <jansson.h>
 
-#include "benchmark.h"
 #include "printing.h"
-#include "ipc.h"
 
 void
 print_all(int size, ccnt_t array[size])
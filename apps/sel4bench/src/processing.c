@@ -10,18 +10,162 @@
  * @TAG(DATA61_GPL)
  */
 
-#include <benchmark.h>
+#include <sel4benchapp/gen_config.h>
+#include <sel4benchsupport/results.h>
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include <utils/zf_log.h>
 #include <utils/config.h>
+#include <utils/util.h>
 
-#include "ipc.h"
 #include "processing.h"
 #include "math.h"
 #include "printing.h"
 
+/* results from repeated launches of the same benchmark, see processing_start_runs() */
+static struct {
+    /* results being processed, NULL if there are no other runs to combine them with */
+    char *primary;
+    /* size of the results of each run */
+    size_t size;
+    /* results of the other runs */
+    size_t n_others;
+    char **others;
+    /* check whether results have converged if non-zero, and the outcome */
+    double max_ci_width;
+    bool converged;
+    /* buffers holding combined results, freed by processing_finish_runs() */
+    void **combined;
+    size_t n_combined;
+} runs;
+
+void
+processing_start_runs(void *primary, size_t size, size_t n_others, void *others[n_others],
+                      double max_ci_width)
+{
+    runs.primary = primary;
+    runs.size = size;
+    runs.n_others = n_others;
+    runs.others = (char **) others;
+    runs.max_ci_width = max_ci_width;
+    runs.converged = true;
+}
+
+bool
+processing_finish_runs(void)
+{
+    for (size_t i = 0; i < runs.n_combined; i++) {
+        free(runs.combined[i]);
+    }
+    free(runs.combined);
+
+    bool converged = runs.converged;
+    memset(&runs, 0, sizeof(runs));
+    return converged;
+}
+
+/*
+ * Check whether size bytes at start are part of the primary results, so that the same bytes of the
+ * results of every other run hold the same result. Results outside of them, e.g a copy made by the
+ * benchmark, cannot be combined.
+ */
+static bool
+in_primary(const void *start, size_t size)
+{
+    const char *bytes = start;
+    return runs.primary != NULL && bytes >= runs.primary && bytes + size <= runs.primary + runs.size;
+}
+
+/* report a result that cannot be combined with the other runs, when the results are output */
+static void
+report_uncombined(const char *name)
+{
+    if (runs.n_others > 0 && runs.max_ci_width == 0) {
+        ZF_LOGW("%s: only the results of the first launch can be used",
+                name == NULL ? "unknown" : name);
+    }
+}
+
+/* allocate a buffer for combined results, which is freed by processing_finish_runs() */
+static void *
+alloc_combined(size_t size)
+{
+    void *combined = malloc(size);
+    void **buffers = realloc(runs.combined, (runs.n_combined + 1) * sizeof(void *));
+    ZF_LOGF_IF(combined == NULL || buffers == NULL, "Failed to allocate memory to combine results");
+    runs.combined = buffers;
+    runs.combined[runs.n_combined++] = combined;
+    return combined;
+}
+
+/* the same bytes as start in the results of another run */
+static void *
+other_run(size_t run, const void *start)
+{
+    return &runs.others[run][(const char *) start - runs.primary];
+}
+
+/*
+ * Combine n samples starting at array in the primary results with the samples at the same offset in
+ * the results of every other run, skipping the first ignored samples of each run.
+ *
+ * Returns NULL if there is nothing to combine with.
+ */
+static ccnt_t *
+combine_runs(size_t n, ccnt_t array[n], size_t ignored, size_t *n_combined)
+{
+    if (runs.n_others == 0) {
+        return NULL;
+    }
+
+    size_t size = n - ignored;
+    ccnt_t *combined = alloc_combined(size * (runs.n_others + 1) * sizeof(ccnt_t));
+    memcpy(combined, &array[ignored], size * sizeof(ccnt_t));
+    for (size_t i = 0; i < runs.n_others; i++) {
+        ccnt_t *other = other_run(i, array);
+        memcpy(&combined[size * (i + 1)], &other[ignored], size * sizeof(ccnt_t));
+    }
+
+    *n_combined = size * (runs.n_others + 1);
+    return combined;
+}
+
+/* merge a histogram with the histograms at the same offset in every other run */
+static const histogram_t *
+combine_histograms(const histogram_t *histogram)
+{
+    if (runs.n_others == 0) {
+        return histogram;
+    }
+
+    histogram_t *combined = alloc_combined(sizeof(histogram_t));
+    memcpy(combined, histogram, sizeof(histogram_t));
+    for (size_t i = 0; i < runs.n_others; i++) {
+        const histogram_t *other = other_run(i, histogram);
+        for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            combined->counts[bucket] += other->counts[bucket];
+        }
+        combined->count += other->count;
+        combined->sum += other->sum;
+        combined->min = MIN(combined->min, other->min);
+        combined->max = MAX(combined->max, other->max);
+    }
+    return combined;
+}
+
 void
 process_average_results(int rows, int cols, ccnt_t array[rows][cols], result_t results[cols])
 {
+    /* the rows of each other run are added to the rows of this one */
+    size_t n_runs = 1;
+    if (in_primary(array, rows * cols * sizeof(ccnt_t))) {
+        n_runs += runs.n_others;
+    } else {
+        report_uncombined("averaged results");
+    }
+
     /* first divide results by no of runs */
     for (int row = 0; row < rows; row++) {
         for (int col = 0; col < cols; col++) {
@@ -35,22 +179,75 @@ process_average_results(int rows, int cols, ccnt_t array[rows][cols], result_t r
          * the 2D array is arranged to minimise benchmark impact such that we write to sequential memory addresses in each loop of the benchmark,
          * additionally we calloc the copy such that the raw data pointed to by the result does not exist on the stack. A different approach will be
          * required if we run out of memory */
-        ccnt_t *raw_data = calloc(rows, sizeof(ccnt_t));
+        ccnt_t *raw_data = calloc(rows * n_runs, sizeof(ccnt_t));
         assert(raw_data != NULL);
 
         for (int i = 0; i < rows; i++) {
             raw_data[i] = array[i][col];
         }
+        /* only the primary results are modified, so the other runs still need dividing */
+        for (size_t run = 1; run < n_runs; run++) {
+            ccnt_t (*other)[cols] = other_run(run - 1, array);
+            for (int i = 0; i < rows; i++) {
+                raw_data[run * rows + i] = other[i][col] / AVERAGE_RUNS;
+            }
+        }
 
-        results[col] = calculate_results(rows, raw_data);
+        results[col] = calculate_results(rows * n_runs, raw_data);
     }
 }
 
+/*
+ * Find the number of warm up samples at the start of array using MSER (marginal standard error
+ * rule): the truncation point d that minimises the variance of the remaining samples divided by
+ * the number of remaining samples squared. At most half of the samples are discarded.
+ */
+static size_t
+detect_warmup(size_t n, const ccnt_t array[n])
+{
+    /* mean and sum of squared deviations of array[d..n), built from the end backwards */
+    long double mean = 0;
+    long double m2 = 0;
+    long double best = INFINITY;
+    size_t warmup = 0;
+
+    for (size_t d = n; d-- > 0;) {
+        const size_t count = n - d;
+        const long double delta = (long double) array[d] - mean;
+        mean += delta / count;
+        m2 += delta * ((long double) array[d] - mean);
+
+        /* keep the smallest truncation point on a tie, so nothing is discarded needlessly */
+        if (d <= n / 2 && count > 1 && m2 / ((long double) count * count) <= best) {
+            best = m2 / ((long double) count * count);
+            warmup = d;
+        }
+    }
+
+    return warmup;
+}
+
 result_t
 process_result(size_t n, ccnt_t array[n], result_desc_t desc)
 {
-    array = &array[desc.ignored];
-    int size = n - desc.ignored;
+    size_t ignored = desc.ignored;
+    if (config_set(CONFIG_AUTO_DETECT_WARMUP)) {
+        ignored = detect_warmup(n, array);
+        ZF_LOGV("%s: discarding %zu warm up samples", desc.name == NULL ? "unknown" : desc.name,
+                ignored);
+    }
+
+    size_t n_combined;
+    ccnt_t *combined = NULL;
+    bool combinable = in_primary(array, n * sizeof(ccnt_t));
+    if (combinable) {
+        combined = combine_runs(n, array, ignored, &n_combined);
+    } else {
+        report_uncombined(desc.name);
+    }
+
+    array = &array[ignored];
+    int size = n - ignored;
 
     if (desc.stable && !results_stable(array, size)) {
         ZF_LOGW("%s cycles are not stable\n", desc.name == NULL ? "unknown" : desc.name);
@@ -62,11 +259,46 @@ process_result(size_t n, ccnt_t array[n], result_desc_t desc)
         }
     }
 
+    if (combined != NULL) {
+        /* the combined results are a copy, the results of each run are left untouched */
+        array = combined;
+        size = n_combined;
+    }
+
     for (int i = 0; i < size; i++) {
         array[i] -= desc.overhead;
     }
 
-    return calculate_results(size, array);
+    /* more launches cannot narrow the interval of a result that is not combined */
+    if (runs.max_ci_width > 0 && combinable && !desc.stable &&
+        calculate_median_ci_width(size, array) > runs.max_ci_width) {
+        runs.converged = false;
+    }
+
+    result_t result = calculate_results(size, array);
+    result.ignored = ignored;
+    result.counts_events = desc.counts_events;
+    return result;
+}
+
+result_t
+process_histogram(const histogram_t *histogram, result_desc_t desc)
+{
+    bool combinable = in_primary(histogram, sizeof(histogram_t));
+    if (combinable) {
+        histogram = combine_histograms(histogram);
+    } else {
+        report_uncombined(desc.name);
+    }
+
+    result_t result = calculate_histogram_results(histogram, desc.overhead);
+    result.counts_events = desc.counts_events;
+
+    if (runs.max_ci_width > 0 && combinable && result.median > 0 &&
+        (result.median_ci_upper - result.median_ci_lower) / result.median > runs.max_ci_width) {
+        runs.converged = false;
+    }
+    return result;
 }
 
 void
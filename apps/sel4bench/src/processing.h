@@ -12,7 +12,32 @@
 
 #pragma once
 
-#include "benchmark.h"
+#include <histogram.h>
+#include "results.h"
+
+/*
+ * Combine the results of several launches of the same benchmark.
+ *
+ * Until processing_finish_runs() is called, process_result() combines samples from within the
+ * primary results with the samples at the same offset in each of the other results. Only the
+ * primary results are modified by processing, so the same runs can be processed more than once.
+ *
+ * @param primary           results that will be passed to the benchmark's process function.
+ * @param size              size of the results of each run in bytes.
+ * @param n_others          number of other runs.
+ * @param others            results of the other runs.
+ * @param max_ci_width      if non-zero, check that the confidence interval of the median of each
+ *                          result is at most this wide, relative to the median.
+ */
+void processing_start_runs(void *primary, size_t size, size_t n_others, void *others[n_others],
+                           double max_ci_width);
+
+/*
+ * Stop combining results, and free any memory used to combine them.
+ *
+ * @return true if every result that was checked converged.
+ */
+bool processing_finish_runs(void);
 
 /*
  * Compute the variance, standard deviation, mean, min and max for a set of values.
@@ -35,6 +60,14 @@ result_t process_result(size_t n, ccnt_t array[n], result_desc_t desc);
 void process_results(size_t ncols, size_t nrows, ccnt_t array[ncols][nrows], result_desc_t desc,
                      result_t results[ncols]);
 
+/**
+ * Compute the same results as process_result() for values recorded in a histogram.
+ *
+ * Only desc.overhead is used: the benchmark should not record samples that are to be ignored,
+ * and stability cannot be checked without the raw values. The results have no raw data.
+ */
+result_t process_histogram(const histogram_t *histogram, result_desc_t desc);
+
 /**
  * Process a table of results that need to be divided by AVERAGE_RUNS
  *
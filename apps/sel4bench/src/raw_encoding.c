@@ -0,0 +1,263 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+#include <string.h>
+#include "raw_encoding.h"
+
+static const char base64_alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+uint32_t
+raw_encoding_crc32(uint32_t crc, const uint8_t *buf, size_t len)
+{
+    /* nibble at a time, which keeps the table small */
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+        0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc >> 4) ^ table[(crc ^ buf[i]) & 0xF];
+        crc = (crc >> 4) ^ table[(crc ^ (buf[i] >> 4)) & 0xF];
+    }
+    return ~crc;
+}
+
+static size_t
+put_varint(uint8_t *buf, uint64_t value)
+{
+    size_t len = 0;
+    while (value >= 0x80) {
+        buf[len++] = (uint8_t) value | 0x80;
+        value >>= 7;
+    }
+    buf[len++] = (uint8_t) value;
+    return len;
+}
+
+/* returns the number of bytes read, or 0 if the varint is truncated or too long */
+static size_t
+get_varint(const uint8_t *buf, size_t len, uint64_t *value)
+{
+    *value = 0;
+    for (size_t i = 0; i < len && i < RAW_ENCODING_MAX_VARINT_SIZE; i++) {
+        *value |= (uint64_t)(buf[i] & 0x7F) << (7 * i);
+        if (!(buf[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static inline uint64_t
+zigzag_encode(int64_t value)
+{
+    return ((uint64_t) value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t
+zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+size_t
+raw_encode_frame(size_t n, const uint64_t samples[n], uint8_t *frame)
+{
+    /* the header size depends on the payload size, so encode the payload after the largest
+     * possible header then move it into place */
+    uint8_t *payload = &frame[1 + 2 * RAW_ENCODING_MAX_VARINT_SIZE];
+    size_t payload_len = 0;
+    uint64_t prev = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        /* wrapping subtraction, the decoder wraps back the same way */
+        payload_len += put_varint(&payload[payload_len], zigzag_encode((int64_t)(samples[i] - prev)));
+        prev = samples[i];
+    }
+
+    size_t len = 0;
+    frame[len++] = RAW_ENCODING_MAGIC;
+    len += put_varint(&frame[len], n);
+    len += put_varint(&frame[len], payload_len);
+    memmove(&frame[len], payload, payload_len);
+    len += payload_len;
+
+    uint32_t crc = raw_encoding_crc32(0, frame, len);
+    for (size_t i = 0; i < sizeof(crc); i++) {
+        frame[len++] = crc >> (8 * i);
+    }
+
+    return len;
+}
+
+int
+raw_decode_frame(const uint8_t *buf, size_t len, uint64_t *samples, size_t *n_samples,
+                 size_t *consumed)
+{
+    uint64_t n, payload_len;
+    size_t pos = 1;
+
+    if (len < 1 || buf[0] != RAW_ENCODING_MAGIC) {
+        return -1;
+    }
+
+    size_t read = get_varint(&buf[pos], len - pos, &n);
+    if (read == 0 || n > RAW_ENCODING_FRAME_SAMPLES) {
+        return -1;
+    }
+    pos += read;
+
+    read = get_varint(&buf[pos], len - pos, &payload_len);
+    if (read == 0 || payload_len > len - pos - read || len - pos - read - payload_len < sizeof(uint32_t)) {
+        return -1;
+    }
+    pos += read;
+
+    size_t end = pos + payload_len;
+    uint32_t crc = 0;
+    for (size_t i = 0; i < sizeof(crc); i++) {
+        crc |= (uint32_t) buf[end + i] << (8 * i);
+    }
+    if (crc != raw_encoding_crc32(0, buf, end)) {
+        return -1;
+    }
+
+    uint64_t prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t value;
+        read = get_varint(&buf[pos], end - pos, &value);
+        if (read == 0) {
+            return -1;
+        }
+        pos += read;
+        prev += (uint64_t) zigzag_decode(value);
+        samples[i] = prev;
+    }
+
+    if (pos != end) {
+        return -1;
+    }
+
+    *n_samples = n;
+    *consumed = end + sizeof(crc);
+    return 0;
+}
+
+static void
+base64_encode_group(const uint8_t in[3], char out[4])
+{
+    out[0] = base64_alphabet[in[0] >> 2];
+    out[1] = base64_alphabet[((in[0] & 0x3) << 4) | (in[1] >> 4)];
+    out[2] = base64_alphabet[((in[1] & 0xF) << 2) | (in[2] >> 6)];
+    out[3] = base64_alphabet[in[2] & 0x3F];
+}
+
+void
+base64_encoder_init(base64_encoder_t *encoder)
+{
+    encoder->n_pending = 0;
+}
+
+size_t
+base64_encode_update(base64_encoder_t *encoder, const uint8_t *in, size_t len, char *out)
+{
+    size_t written = 0;
+
+    /* complete the group left over from last time */
+    while (encoder->n_pending > 0 && encoder->n_pending < 3 && len > 0) {
+        encoder->pending[encoder->n_pending++] = *in++;
+        len--;
+    }
+    if (encoder->n_pending == 3) {
+        base64_encode_group(encoder->pending, &out[written]);
+        written += 4;
+        encoder->n_pending = 0;
+    }
+
+    for (; len >= 3; in += 3, len -= 3) {
+        base64_encode_group(in, &out[written]);
+        written += 4;
+    }
+
+    /* keep anything left for the next update */
+    for (; len > 0; len--) {
+        encoder->pending[encoder->n_pending++] = *in++;
+    }
+
+    return written;
+}
+
+size_t
+base64_encode_finish(base64_encoder_t *encoder, char *out)
+{
+    if (encoder->n_pending == 0) {
+        return 0;
+    }
+
+    uint8_t group[3] = {0};
+    memcpy(group, encoder->pending, encoder->n_pending);
+    base64_encode_group(group, out);
+    for (size_t i = encoder->n_pending + 1; i < 4; i++) {
+        out[i] = '=';
+    }
+    encoder->n_pending = 0;
+    return 4;
+}
+
+static int
+base64_value(char c)
+{
+    const char *pos = memchr(base64_alphabet, c, sizeof(base64_alphabet) - 1);
+    return (c == '\0' || pos == NULL) ? -1 : pos - base64_alphabet;
+}
+
+long
+base64_decode(const char *in, size_t len, uint8_t *out)
+{
+    long written = 0;
+
+    if (len % 4 != 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < len; i += 4) {
+        int values[4];
+        int n_padding = 0;
+        for (int j = 0; j < 4; j++) {
+            if (in[i + j] == '=' && i + 4 == len && j >= 2) {
+                values[j] = 0;
+                n_padding++;
+            } else if (n_padding > 0) {
+                return -1;
+            } else {
+                values[j] = base64_value(in[i + j]);
+                if (values[j] < 0) {
+                    return -1;
+                }
+            }
+        }
+
+        uint32_t group = (values[0] << 18) | (values[1] << 12) | (values[2] << 6) | values[3];
+        out[written++] = group >> 16;
+        if (n_padding < 2) {
+            out[written++] = group >> 8;
+        }
+        if (n_padding < 1) {
+            out[written++] = group;
+        }
+    }
+
+    return written;
+}
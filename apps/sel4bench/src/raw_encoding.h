@@ -0,0 +1,90 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+#pragma once
+
+/*
+ * Compact encoding for raw results.
+ *
+ * Samples are split into frames of at most RAW_ENCODING_FRAME_SAMPLES. Each frame is laid out as:
+ *
+ *   magic (1 byte) | n_samples (varint) | payload length (varint) | payload | crc32 (4 bytes, LE)
+ *
+ * The payload holds the difference between each sample and the one before it (the first sample
+ * of each frame is relative to 0), zig-zag encoded so that small negative differences stay small,
+ * then written as an unsigned LEB128 varint. The crc32 covers everything in the frame before it.
+ * Each frame can be decoded on its own.
+ *
+ * A stream of frames is sent as base64 so it can be embedded in the JSON output.
+ *
+ * This file is shared with the host side decoder, so must not depend on anything from seL4.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RAW_ENCODING_MAGIC 0xB5
+/* maximum number of samples in a single frame */
+#define RAW_ENCODING_FRAME_SAMPLES 256
+/* a 64 bit value takes at most 10 bytes as a varint */
+#define RAW_ENCODING_MAX_VARINT_SIZE 10
+#define RAW_ENCODING_MAX_PAYLOAD_SIZE (RAW_ENCODING_FRAME_SAMPLES * RAW_ENCODING_MAX_VARINT_SIZE)
+#define RAW_ENCODING_MAX_FRAME_SIZE (1 + 2 * RAW_ENCODING_MAX_VARINT_SIZE + \
+                                     RAW_ENCODING_MAX_PAYLOAD_SIZE + sizeof(uint32_t))
+
+/* output size of base64 encoding len bytes, including padding */
+#define BASE64_ENCODED_SIZE(len) ((((len) + 2) / 3) * 4)
+
+/* state for base64 encoding a stream that arrives in pieces */
+typedef struct {
+    /* bytes left over from the last update that did not make up a full 3 byte group */
+    uint8_t pending[3];
+    size_t n_pending;
+} base64_encoder_t;
+
+/* standard crc32 (as used by zlib), pass 0 as crc to start a new checksum */
+uint32_t raw_encoding_crc32(uint32_t crc, const uint8_t *buf, size_t len);
+
+/*
+ * Encode a frame.
+ *
+ * @param n       number of samples, must be at most RAW_ENCODING_FRAME_SAMPLES.
+ * @param samples the samples to encode.
+ * @param frame   output, must be at least RAW_ENCODING_MAX_FRAME_SIZE bytes.
+ * @return        size of the encoded frame in bytes.
+ */
+size_t raw_encode_frame(size_t n, const uint64_t samples[n], uint8_t *frame);
+
+/*
+ * Decode the frame at the start of buf.
+ *
+ * @param len       number of bytes available in buf.
+ * @param samples   output, must have room for RAW_ENCODING_FRAME_SAMPLES.
+ * @param n_samples output, number of samples decoded.
+ * @param consumed  output, number of bytes in the frame.
+ * @return          0 on success, -1 if the frame is truncated or corrupt.
+ */
+int raw_decode_frame(const uint8_t *buf, size_t len, uint64_t *samples, size_t *n_samples,
+                     size_t *consumed);
+
+void base64_encoder_init(base64_encoder_t *encoder);
+/* encode len bytes from in, out must have room for BASE64_ENCODED_SIZE(len) characters.
+ * Returns the number of characters written. */
+size_t base64_encode_update(base64_encoder_t *encoder, const uint8_t *in, size_t len, char *out);
+/* flush any remaining bytes with padding, out must have room for 4 characters */
+size_t base64_encode_finish(base64_encoder_t *encoder, char *out);
+
+/*
+ * Decode len characters of base64 from in into out, which must have room for len / 4 * 3 bytes.
+ *
+ * @return the number of bytes decoded, or -1 if the input is not valid base64.
+ */
+long base64_decode(const char *in, size_t len, uint8_t *out);
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+#pragma once
+
+/*
+ * Types used to process and output results.
+ *
+ * These are kept apart from the rest of the driver, which depends on seL4, so that the processing
+ * code can also be built for the host (see host/CMakeLists.txt).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <jansson.h>
+#include <sel4bench/sel4bench.h>
+
+/* generic result type */
+typedef struct {
+    double variance;
+    double stddev;
+    double mean;
+    ccnt_t min;
+    ccnt_t max;
+    ccnt_t mode;
+    double median;
+    /* 95% confidence intervals */
+    double mean_ci_lower;
+    double mean_ci_upper;
+    double median_ci_lower;
+    double median_ci_upper;
+    double first_quantile;
+    double third_quantile;
+    /* tail percentiles */
+    double p90;
+    double p99;
+    double p999;
+    /* median absolute deviation from the median */
+    double mad;
+    /* mean of the samples between the 10th and 90th percentiles */
+    double trimmed_mean;
+    /* number of samples more than 1.5 interquartile ranges outside the quartiles */
+    size_t outliers;
+    size_t samples;
+    /* number of samples discarded as warm up before calculating the results */
+    size_t ignored;
+    /* NULL if the results were calculated from a histogram */
+    ccnt_t *raw_data;
+    /* the samples count something other than cycles, so are not converted to ns */
+    bool counts_events;
+} result_t;
+
+typedef struct {
+    /* header to print at top of column */
+    char *header;
+    /* pointer to first element in array of column values - length must match n_results in the
+     * result_set_t that this column is used with. NaN in a real column is written as null, for
+     * rows that the column does not apply to. */
+    union {
+        char **string_array;
+        json_int_t *integer_array;
+        double *real_array;
+        bool *bool_array;
+    };
+    /* type of the column */
+    json_type type;
+} column_t;
+
+/* describes result output */
+typedef struct {
+    /* name of the result set */
+    const char *name;
+    /* columns to prepend to result output */
+    column_t *extra_cols;
+    /* number of extra columns */
+    int n_extra_cols;
+    /* array of results */
+    result_t *results;
+    /* number of results in this set */
+    int n_results;
+} result_set_t;
+
+/* description of how to process a result */
+typedef struct {
+    /* error if result should be stable */
+    bool stable;
+    /* name of result */
+    const char *name;
+    /* overhead to subtract from each result before calculations */
+    ccnt_t overhead;
+    /* number of samples to ignore (for cold cache values). Replaced by the number detected
+     * from the samples if CONFIG_AUTO_DETECT_WARMUP is set. */
+    int ignored;
+    /* the samples count something other than cycles, e.g a generic event or completed calls */
+    bool counts_events;
+} result_desc_t;
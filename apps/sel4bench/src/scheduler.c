@@ -17,7 +17,7 @@
 #include <stdio.h>
 
 static void
-process_yield_results(scheduler_results_t *results, ccnt_t overhead, json_t *array)
+process_yield_results(scheduler_results_t *results, ccnt_t overhead, json_writer_t *writer)
 {
     result_desc_t desc = {
         .ignored = N_IGNORED,
@@ -33,20 +33,19 @@ process_yield_results(scheduler_results_t *results, ccnt_t overhead, json_t *arr
     };
 
     result = process_result(N_RUNS, results->thread_yield, desc);
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     set.name = "Process yield";
     result = process_result(N_RUNS, results->process_yield, desc);
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     result_t average_results[NUM_AVERAGE_EVENTS];
     process_average_results(N_RUNS, NUM_AVERAGE_EVENTS, results->average_yield, average_results);
-    json_array_append_new(array, average_counters_to_json("Average seL4_Yield (no thread switch)",
-                                                           average_results));
+    json_write_average_counters(writer, "Average seL4_Yield (no thread switch)", average_results);
 }
 
 static void
-process_scheduler_results(scheduler_results_t *results, json_t *array)
+process_scheduler_results(scheduler_results_t *results, json_writer_t *writer)
 {
     result_desc_t desc = {
         .stable = true,
@@ -63,7 +62,7 @@ process_scheduler_results(scheduler_results_t *results, json_t *array)
         .results = &result,
         .n_results = 1,
     };
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     /* thread switch overhead */
     desc.stable = false;
@@ -89,24 +88,22 @@ process_scheduler_results(scheduler_results_t *results, json_t *array)
     set.n_extra_cols = 1,
     set.results = per_prio_result,
     set.n_results = N_PRIOS,
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     set.name = "Signal to process of higher prio";
     process_results(N_PRIOS, N_RUNS, results->process_results, desc, per_prio_result);
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     result_t average_results[NUM_AVERAGE_EVENTS];
     process_average_results(N_RUNS, NUM_AVERAGE_EVENTS, results->set_prio_average, average_results);
-    json_array_append_new(array, average_counters_to_json("Average to reschedule current thread",
-                                                           average_results));
+    json_write_average_counters(writer, "Average to reschedule current thread", average_results);
 }
 
-static json_t *
-scheduler_process(void *results) {
+static int
+scheduler_process(void *results, json_writer_t *writer) {
     scheduler_results_t *raw_results = results;
-    json_t *array = json_array();
 
-    process_scheduler_results(raw_results, array);
+    process_scheduler_results(raw_results, writer);
 
     result_desc_t desc = {
         .name = "Read ccnt overhead",
@@ -123,11 +120,11 @@ scheduler_process(void *results) {
         .n_results = 1
     };
 
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
-    process_yield_results(raw_results, ccnt_overhead.min, array);
+    process_yield_results(raw_results, ccnt_overhead.min, writer);
 
-    return array;
+    return 0;
 }
 
 static benchmark_t sched_benchmark = {
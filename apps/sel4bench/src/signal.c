@@ -16,8 +16,8 @@
 #include <sel4benchsupport/signal.h>
 #include <stdio.h>
 
-static json_t *
-signal_process(void *results) {
+static int
+signal_process(void *results, json_writer_t *writer) {
     signal_results_t *raw_results = results;
 
     result_desc_t desc = {
@@ -35,27 +35,81 @@ signal_process(void *results) {
         .results = &result
     };
 
-    json_t *array = json_array();
-    json_array_append_new(array, result_set_to_json(set));
+    json_write_result_set(writer, set);
 
     desc.stable = false;
     desc.overhead = result.min;
+    ccnt_t overhead = result.min;
 
-    result = process_result(N_RUNS, raw_results->lo_prio_results, desc);
-    set.name = "Signal to high prio thread";
-    json_array_append_new(array, result_set_to_json(set));
+    result_t cache_results[N_CACHE_STATES];
+    process_results(N_CACHE_STATES, N_RUNS, raw_results->lo_prio_results, desc, cache_results);
+    json_write_cache_states(writer, "Signal to high prio thread", cache_results);
 
-    result = process_result(N_RUNS, raw_results->hi_prio_results, desc);
-    set.name = "Signal to low prio thread";
-    json_array_append_new(array, result_set_to_json(set));
+    process_results(N_CACHE_STATES, N_RUNS, raw_results->hi_prio_results, desc, cache_results);
+    json_write_cache_states(writer, "Signal to low prio thread", cache_results);
+
+    result = process_histogram(&raw_results->hi_prio_histogram, desc);
+    set.name = "Signal to low prio thread (histogram)";
+    json_write_result_set(writer, set);
 
     result_t average_results[NUM_AVERAGE_EVENTS];
     process_average_results(N_RUNS, NUM_AVERAGE_EVENTS, raw_results->hi_prio_average, average_results);
 
-    json_array_append_new(array, average_counters_to_json("Average signal to low prio thread",
-                                                           average_results));
+    json_write_average_counters(writer, "Average signal to low prio thread", average_results);
+
+    /* a notification bound to a thread in Recv on an endpoint */
+    result = process_result(N_RUNS, raw_results->bound_results, desc);
+    set.name = "Signal to high prio thread in Recv with bound notification";
+    json_write_result_set(writer, set);
+
+    json_int_t signallers[N_FAN_IN_LEVELS];
+    column_t signallers_col = {
+        .header = "Signallers",
+        .type = JSON_INTEGER,
+        .integer_array = &signallers[0]
+    };
+    result_t fan_in_results[N_FAN_IN_LEVELS];
+    for (int i = 0; i < N_FAN_IN_LEVELS; i++) {
+        signallers[i] = BIT(i);
+    }
+    process_results(N_FAN_IN_LEVELS, N_RUNS, raw_results->fan_in_results, desc, fan_in_results);
+    result_set_t fan_in_set = {
+        .name = "Badge fan-in to thread in Recv with bound notification",
+        .n_results = N_FAN_IN_LEVELS,
+        .n_extra_cols = 1,
+        .extra_cols = &signallers_col,
+        .results = fan_in_results
+    };
+    json_write_result_set(writer, fan_in_set);
+
+    /* these are a Recv on its own */
+    desc.overhead = process_result(N_RUNS, raw_results->wait_overhead,
+                                   (result_desc_t) { .name = "wait overhead", .ignored = N_IGNORED }).min;
+
+    result = process_result(N_RUNS, raw_results->bound_pending_results, desc);
+    set.name = "Recv with pending bound notification and queued message";
+    json_write_result_set(writer, set);
+
+    result = process_result(N_RUNS, raw_results->bound_queued_results, desc);
+    set.name = "Recv of queued message after bound notification";
+    json_write_result_set(writer, set);
+
+    desc.overhead = overhead;
+
+    if (config_set(CONFIG_MEMORY_INTERFERENCE)) {
+        result_t interference_results[N_INTERFERENCE_LEVELS];
+        process_results(N_INTERFERENCE_LEVELS, N_RUNS, raw_results->lo_prio_interference, desc,
+                        interference_results);
+        json_write_interference(writer, "Signal to high prio thread under memory interference",
+                                interference_results);
+
+        process_results(N_INTERFERENCE_LEVELS, N_RUNS, raw_results->hi_prio_interference, desc,
+                        interference_results);
+        json_write_interference(writer, "Signal to low prio thread under memory interference",
+                                interference_results);
+    }
 
-    return array;
+    return 0;
 }
 
 static benchmark_t signal_benchmark = {
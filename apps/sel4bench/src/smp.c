@@ -24,22 +24,38 @@
 
 static int cores_collective_results;
 
+static benchmark_t smp_benchmark;
+
 static void
 process_smp_results_init(UNUSED vka_t *vka, simple_t *simple, UNUSED sel4utils_process_t *process)
 {
     cores_collective_results = simple_get_core_count(simple);
 }
 
-static json_t *
-process_smp_results(void *r)
+static int
+process_smp_results(void *r, json_writer_t *writer)
 {
     smp_results_t *raw_results = r;
 
-    int n = TESTS * cores_collective_results;
+    /* only the tests selected by the runtime config were run */
+    const char *config = smp_benchmark.config;
+    size_t runs = runtime_config_runs(config, RUNS);
+    int n_tests = runtime_config_num_params(config, TESTS);
+    if (n_tests == 0) {
+        return 0;
+    }
+    int selected[n_tests];
+    for (int i = 0, t = 0; i < TESTS; i++) {
+        if (runtime_config_param_enabled(config, i)) {
+            selected[t++] = i;
+        }
+    }
+
+    int n = n_tests * cores_collective_results;
 
     json_int_t cycle_col[n], cores_col[n];
     for (int i = 0; i < n; i++) {
-        cycle_col[i] = smp_benchmark_params[i / cores_collective_results].delay;
+        cycle_col[i] = smp_benchmark_params[selected[i / cores_collective_results]].delay;
         cores_col[i] = (i % cores_collective_results) + 1;
     }
 
@@ -56,7 +72,7 @@ process_smp_results(void *r)
         },
     };
 
-    result_t results[TESTS][cores_collective_results];
+    result_t results[n_tests][cores_collective_results];
 
     result_set_t result_set = {
         .name = "SMP Benchmark",
@@ -66,24 +82,27 @@ process_smp_results(void *r)
         .n_results = n,
     };
 
-    for (int i = 0; i < TESTS; i++) {
+    for (int i = 0; i < n_tests; i++) {
         for (int j = 0; j < cores_collective_results; j++) {
+            /* the results are counts of completed calls */
             result_desc_t desc = {
-                .name = smp_benchmark_params[i].name,
+                .name = smp_benchmark_params[selected[i]].name,
                 .overhead = 0,
+                .counts_events = true,
             };
-            results[i][j] = process_result(RUNS, raw_results->benchmarks_result[i][j], desc);
+            results[i][j] = process_result(runs, raw_results->benchmarks_result[selected[i]][j],
+                                           desc);
         }
     }
 
-    json_t *array = json_array();
-    json_array_append_new(array, result_set_to_json(result_set));
-    return array;
+    json_write_result_set(writer, result_set);
+    return 0;
 }
 
 static benchmark_t smp_benchmark = {
     .name = "smp",
     .enabled = config_set(CONFIG_APP_SMPBENCH),
+    .uses_timer = true,
     .results_pages = BYTES_TO_SIZE_BITS_PAGES(sizeof(smp_results_t), seL4_PageBits),
     .process = process_smp_results,
     .init = process_smp_results_init
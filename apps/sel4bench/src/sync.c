@@ -16,8 +16,8 @@
 #include <sync.h>
 #include <stdio.h>
 
-static json_t *
-sync_process(void *results) {
+static int
+sync_process(void *results, json_writer_t *writer) {
     sync_results_t *raw_results = results;
 
     result_desc_t desc = {
@@ -48,12 +48,10 @@ sync_process(void *results) {
         .n_results = N_WAITERS,
     };
 
-    json_t *array = json_array();
-
     for (int j = 0; j < N_BROADCAST_BENCHMARKS; ++j) {
         process_results(N_WAITERS, N_RUNS, raw_results->broadcast_wait_time[j], desc, wait_results);
         set.name = broadcast_wait_names[j];
-        json_array_append_new(array, result_set_to_json(set));
+        json_write_result_set(writer, set);
     }
 
     result_t result;
@@ -65,22 +63,22 @@ sync_process(void *results) {
     for (int j = 0; j < N_BROADCAST_BENCHMARKS; ++j) {
         result = process_result(N_RUNS, raw_results->broadcast_broadcast_time[j], desc);
         set.name = broadcast_broadcast_names[j];
-        json_array_append_new(array, result_set_to_json(set));
+        json_write_result_set(writer, set);
     }
 
     for (int j = 0; j < N_PROD_CONS_BENCHMARKS; ++j) {
         result = process_result(N_RUNS, raw_results->producer_to_consumer[j], desc);
         set.name = producer_to_consumer_names[j];
-        json_array_append_new(array, result_set_to_json(set));
+        json_write_result_set(writer, set);
     }
 
     for (int j = 0; j < N_PROD_CONS_BENCHMARKS; ++j) {
         result = process_result(N_RUNS, raw_results->consumer_to_producer[j], desc);
         set.name = consumer_to_producer_names[j];
-        json_array_append_new(array, result_set_to_json(set));
+        json_write_result_set(writer, set);
     }
 
-    return array;
+    return 0;
 }
 
 static benchmark_t sync_benchmark = {
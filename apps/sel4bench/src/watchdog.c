@@ -0,0 +1,161 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#include <autoconf.h>
+#include <sel4benchapp/gen_config.h>
+#include <platsupport/ltimer.h>
+#include <sel4platsupport/io.h>
+#include <sel4platsupport/timer.h>
+#include <utils/util.h>
+#include <vka/object.h>
+
+#include "watchdog.h"
+
+/* the watchdog is only enabled while the driver holds the timer */
+static bool enabled;
+/* time at which the running benchmark's limit expires, and whether one is running */
+static uint64_t deadline;
+static bool armed;
+/* the timer's time goes back to 0 when it is reset or acquired again, so an offset is added to
+ * keep the time read by watchdog_get_time() going forwards */
+static uint64_t offset;
+static uint64_t last_time;
+
+static void acquire_timer(env_t *env)
+{
+    int error = sel4platsupport_init_default_timer_ops(&env->vka, &env->vspace, &env->simple,
+                                                       env->ops, env->timer_ntfn.cptr, &env->timer);
+    if (error) {
+        /* e.g a benchmark that used the timer did not give it back */
+        ZF_LOGE("Failed to initialise timer, running the remaining benchmarks without a time limit");
+        return;
+    }
+    enabled = true;
+}
+
+static void release_timer(env_t *env)
+{
+    sel4platsupport_destroy_timer(&env->timer, &env->vka);
+    enabled = false;
+}
+
+bool watchdog_needs_timer(void)
+{
+    return CONFIG_BENCHMARK_TIMEOUT != 0 || config_set(CONFIG_ADAPTIVE_SAMPLING);
+}
+
+void watchdog_init(env_t *env)
+{
+    if (!watchdog_needs_timer()) {
+        return;
+    }
+
+    acquire_timer(env);
+}
+
+void watchdog_start(env_t *env, benchmark_t *benchmark)
+{
+    if (!enabled) {
+        return;
+    }
+
+    if (benchmark->uses_timer) {
+        ZF_LOGW("%s benchmark needs the timer, running it without a time limit", benchmark->name);
+        release_timer(env);
+        return;
+    }
+
+    if (CONFIG_BENCHMARK_TIMEOUT == 0) {
+        return;
+    }
+
+    uint64_t timeout = (uint64_t) CONFIG_BENCHMARK_TIMEOUT * NS_IN_S;
+    int error = ltimer_get_time(&env->timer.ltimer, &deadline);
+    ZF_LOGF_IF(error, "Failed to read the time for the watchdog");
+    deadline += timeout;
+
+    error = ltimer_set_timeout(&env->timer.ltimer, timeout, TIMEOUT_RELATIVE);
+    ZF_LOGF_IF(error, "Failed to start the watchdog");
+    armed = true;
+}
+
+void watchdog_stop(env_t *env)
+{
+    if (!watchdog_needs_timer()) {
+        return;
+    }
+
+    armed = false;
+    if (enabled) {
+        /* catch up with the time before it is reset */
+        uint64_t time;
+        watchdog_get_time(env, &time);
+        int error = ltimer_reset(&env->timer.ltimer);
+        ZF_LOGF_IF(error, "Failed to stop the watchdog");
+    } else if (env->timer_ntfn.cptr != seL4_CapNull) {
+        /* take the timer back from a benchmark that used it */
+        acquire_timer(env);
+    }
+
+    /* clear a timeout that fired after the benchmark finished, but before it was cancelled, and
+     * acknowledge its irq so that later timeouts are delivered */
+    seL4_Word badge = 0;
+    seL4_Poll(env->timer_ntfn.cptr, &badge);
+    if (enabled && badge != 0) {
+        sel4platsupport_handle_timer_irq(&env->timer, badge);
+    }
+}
+
+bool watchdog_signalled(seL4_MessageInfo_t info)
+{
+    /* every message sent by a benchmark process or the kernel on its behalf has a payload, while
+     * a signal delivered through the bound notification has none */
+    return watchdog_needs_timer() && seL4_MessageInfo_get_length(info) == 0;
+}
+
+bool watchdog_expired(env_t *env, seL4_Word badge)
+{
+    if (!enabled) {
+        return false;
+    }
+
+    sel4platsupport_handle_timer_irq(&env->timer, badge);
+    if (!armed) {
+        return false;
+    }
+
+    /* the irq may be for something other than the timeout, such as the counter overflowing */
+    uint64_t now;
+    int error = ltimer_get_time(&env->timer.ltimer, &now);
+    ZF_LOGF_IF(error, "Failed to read the time for the watchdog");
+    return now >= deadline;
+}
+
+int watchdog_get_time(env_t *env, uint64_t *time)
+{
+    if (!enabled) {
+        return -1;
+    }
+
+    uint64_t now;
+    int error = ltimer_get_time(&env->timer.ltimer, &now);
+    if (error) {
+        return error;
+    }
+
+    if (now + offset < last_time) {
+        offset = last_time - now;
+    }
+    last_time = now + offset;
+    *time = last_time;
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#pragma once
+
+#include <sel4/sel4.h>
+#include <stdbool.h>
+
+#include "benchmark.h"
+#include "env.h"
+
+/*
+ * Watchdog that limits how long each benchmark can run for, see BenchmarkTimeout.
+ *
+ * The watchdog uses the platform timer from the driver's own thread: the timer's notification is
+ * bound to the driver's TCB, so expiry wakes the driver out of the receive on the benchmark's
+ * fault endpoint. Benchmarks that use the timer themselves cannot share it, so the watchdog hands
+ * the timer over for the duration of those benchmarks and they run without a time limit.
+ *
+ * The timer is also kept for AdaptiveSampling, which limits how long each benchmark is relaunched
+ * for with the time from watchdog_get_time().
+ *
+ * All of these functions do nothing if the watchdog is disabled.
+ */
+
+/* whether the driver keeps the timer after calibrating the cycle counter */
+bool watchdog_needs_timer(void);
+
+/* set up the timer, with the io ops and notification from init_timer_objects() in main.c */
+void watchdog_init(env_t *env);
+
+/* start the time limit for benchmark */
+void watchdog_start(env_t *env, benchmark_t *benchmark);
+
+/* cancel the time limit, once the benchmark has finished */
+void watchdog_stop(env_t *env);
+
+/*
+ * Check whether a message received by the driver is a timer signal rather than a message from the
+ * benchmark process.
+ *
+ * @param info message info returned by the receive.
+ * @return true if it is a signal, which should be passed to watchdog_expired().
+ */
+bool watchdog_signalled(seL4_MessageInfo_t info);
+
+/*
+ * Acknowledge the timer irq of a signal, and check whether the time limit has expired. A signal
+ * before the deadline, e.g. for the timer's counter overflowing, does not end the benchmark.
+ *
+ * @param badge badge returned by the receive.
+ * @return true if the time limit has expired.
+ */
+bool watchdog_expired(env_t *env, seL4_Word badge);
+
+/*
+ * Read the time from the timer, which only goes forwards while the driver holds it. Time spent in
+ * a benchmark that uses the timer itself is not counted.
+ *
+ * @param time returns the time in nanoseconds.
+ * @return 0 on success, or non-zero if the driver does not hold the timer.
+ */
+int watchdog_get_time(env_t *env, uint64_t *time);
@@ -25,10 +25,15 @@
 
 #include <arch/signal.h>
 
-#define N_LO_SIGNAL_ARGS 4
-#define N_HI_SIGNAL_ARGS 3
+#define N_LO_SIGNAL_ARGS 5
+#define N_HI_SIGNAL_ARGS 5
 #define N_WAIT_ARGS 3
-#define MAX_ARGS 4
+#define N_BOUND_SIGNAL_ARGS 5
+#define N_PENDING_WAIT_ARGS 4
+#define N_QUEUED_SEND_ARGS 3
+#define N_FAN_IN_SIGNAL_ARGS 6
+#define N_FAN_IN_WAIT_ARGS 4
+#define MAX_ARGS 6
 
 typedef struct helper_thread {
     sel4utils_thread_t thread;
@@ -75,9 +80,13 @@ void low_prio_signal_fn(int argc, char **argv)
     volatile ccnt_t *end = (volatile ccnt_t *) atol(argv[1]);
     ccnt_t *results = (ccnt_t *) atol(argv[2]);
     seL4_CPtr done_ep = (seL4_CPtr) atol(argv[3]);
+    void *cold_cache = (void *) atol(argv[4]);
 
     for (int i = 0; i < N_RUNS; i++) {
         ccnt_t start;
+        if (cold_cache != NULL) {
+            benchmark_pollute_caches(cold_cache);
+        }
         SEL4BENCH_READ_CCNT(start);
         DO_REAL_SIGNAL(ntfn);
         results[i] = (*end - start);
@@ -94,20 +103,45 @@ void high_prio_signal_fn(int argc, char **argv)
     assert(argc == N_HI_SIGNAL_ARGS);
     seL4_CPtr ntfn = (seL4_CPtr) atol(argv[0]);
     signal_results_t *results = (signal_results_t *) atol(argv[1]);
-    seL4_CPtr done_ep = (seL4_CPtr) atol(argv[2]);
+    ccnt_t *first_results = (ccnt_t *) atol(argv[2]);
+    seL4_CPtr done_ep = (seL4_CPtr) atol(argv[3]);
+    void *cold_cache = (void *) atol(argv[4]);
 
     /* first we run a benchmark where we try and read the cycle counter
      * for individual runs - this may not yield a stable result on all platforms
      * due to pipeline, cache etc */
     for (int i = 0; i < N_RUNS; i++) {
         ccnt_t start, end;
+        if (cold_cache != NULL) {
+            benchmark_pollute_caches(cold_cache);
+        }
         COMPILER_MEMORY_FENCE();
         SEL4BENCH_READ_CCNT(start);
         DO_REAL_SIGNAL(ntfn);
         SEL4BENCH_READ_CCNT(end);
         COMPILER_MEMORY_FENCE();
         /* record the result */
-        results->hi_prio_results[i] = (end - start);
+        first_results[i] = (end - start);
+    }
+
+    if (first_results != results->hi_prio_results[CACHE_HOT]) {
+        /* the rest is only measured with hot caches and no interference */
+        seL4_Send(done_ep, seL4_MessageInfo_new(0, 0, 0, 0));
+        seL4_Wait(ntfn, NULL);
+    }
+
+    /* the same again, but for enough runs to see the tail of the distribution */
+    histogram_init(&results->hi_prio_histogram);
+    for (int i = 0; i < N_HISTOGRAM_RUNS + N_IGNORED; i++) {
+        ccnt_t start, end;
+        COMPILER_MEMORY_FENCE();
+        SEL4BENCH_READ_CCNT(start);
+        DO_REAL_SIGNAL(ntfn);
+        SEL4BENCH_READ_CCNT(end);
+        COMPILER_MEMORY_FENCE();
+        if (i >= N_IGNORED) {
+            histogram_record(&results->hi_prio_histogram, end - start);
+        }
     }
 
     /* now run an average benchmark and read the perf counters as well */
@@ -137,6 +171,142 @@ void high_prio_signal_fn(int argc, char **argv)
     seL4_Wait(ntfn, NULL);
 }
 
+/* this signal function expects to wake a higher prio thread that waits in Recv on an endpoint, with
+ * the notification bound to it. It can't block on the notification when it is done, as only the
+ * thread it is bound to can wait on it, so it blocks on another */
+void bound_signal_fn(int argc, char **argv)
+{
+    assert(argc == N_BOUND_SIGNAL_ARGS);
+    seL4_CPtr ntfn = (seL4_CPtr) atol(argv[0]);
+    volatile ccnt_t *end = (volatile ccnt_t *) atol(argv[1]);
+    ccnt_t *results = (ccnt_t *) atol(argv[2]);
+    seL4_CPtr done_ep = (seL4_CPtr) atol(argv[3]);
+    seL4_CPtr park = (seL4_CPtr) atol(argv[4]);
+
+    for (int i = 0; i < N_RUNS; i++) {
+        ccnt_t start;
+        SEL4BENCH_READ_CCNT(start);
+        DO_REAL_SIGNAL(ntfn);
+        results[i] = (*end - start);
+    }
+
+    /* signal completion */
+    seL4_Send(done_ep, seL4_MessageInfo_new(0, 0, 0, 0));
+    /* block */
+    seL4_Wait(park, NULL);
+}
+
+/* Recv on an endpoint that a message is queued on, with a signal pending on the bound
+ * notification. The first Recv returns the signal, and the second the message. */
+void pending_wait_fn(int argc, char **argv)
+{
+    assert(argc == N_PENDING_WAIT_ARGS);
+    seL4_CPtr ep = (seL4_CPtr) atol(argv[0]);
+    seL4_CPtr ntfn = (seL4_CPtr) atol(argv[1]);
+    signal_results_t *results = (signal_results_t *) atol(argv[2]);
+    seL4_CPtr done_ep = (seL4_CPtr) atol(argv[3]);
+
+    for (int i = 0; i < N_RUNS; i++) {
+        ccnt_t start, end;
+        /* let the sender, which has the same prio, queue its message */
+        seL4_Yield();
+        DO_REAL_SIGNAL(ntfn);
+
+        COMPILER_MEMORY_FENCE();
+        SEL4BENCH_READ_CCNT(start);
+        DO_REAL_WAIT(ep);
+        SEL4BENCH_READ_CCNT(end);
+        COMPILER_MEMORY_FENCE();
+        results->bound_pending_results[i] = end - start;
+
+        /* the message sets the message info register, which DO_REAL_WAIT doesn't expect */
+        COMPILER_MEMORY_FENCE();
+        SEL4BENCH_READ_CCNT(start);
+        seL4_Wait(ep, NULL);
+        SEL4BENCH_READ_CCNT(end);
+        COMPILER_MEMORY_FENCE();
+        results->bound_queued_results[i] = end - start;
+    }
+
+    /* signal completion */
+    seL4_Send(done_ep, seL4_MessageInfo_new(0, 0, 0, 0));
+    /* block */
+    seL4_Wait(ep, NULL);
+}
+
+/* queue a message on the endpoint for each run of pending_wait_fn */
+void queued_send_fn(int argc, char **argv)
+{
+    assert(argc == N_QUEUED_SEND_ARGS);
+    seL4_CPtr ep = (seL4_CPtr) atol(argv[0]);
+    seL4_CPtr done_ep = (seL4_CPtr) atol(argv[1]);
+    seL4_CPtr park = (seL4_CPtr) atol(argv[2]);
+
+    for (int i = 0; i < N_RUNS; i++) {
+        seL4_Send(ep, seL4_MessageInfo_new(0, 0, 0, 0));
+    }
+
+    /* signal completion */
+    seL4_Send(done_ep, seL4_MessageInfo_new(0, 0, 0, 0));
+    /* block */
+    seL4_Wait(park, NULL);
+}
+
+/* Signal the notification through each of n badged caps, as n signallers would. The waiter has the
+ * same prio, so it is woken by the first, the rest of the badges are ORed together, and it only
+ * runs to collect them once this thread yields. */
+void fan_in_signal_fn(int argc, char **argv)
+{
+    assert(argc == N_FAN_IN_SIGNAL_ARGS);
+    seL4_CPtr *ntfns = (seL4_CPtr *) atol(argv[0]);
+    int n = atol(argv[1]);
+    volatile ccnt_t *end = (volatile ccnt_t *) atol(argv[2]);
+    ccnt_t *results = (ccnt_t *) atol(argv[3]);
+    seL4_CPtr done_ep = (seL4_CPtr) atol(argv[4]);
+    seL4_CPtr park = (seL4_CPtr) atol(argv[5]);
+
+    for (int i = 0; i < N_RUNS; i++) {
+        ccnt_t start;
+        SEL4BENCH_READ_CCNT(start);
+        for (int j = 0; j < n; j++) {
+            DO_REAL_SIGNAL(ntfns[j]);
+        }
+        seL4_Yield();
+        results[i] = (*end - start);
+    }
+
+    /* signal completion */
+    seL4_Send(done_ep, seL4_MessageInfo_new(0, 0, 0, 0));
+    /* block */
+    seL4_Wait(park, NULL);
+}
+
+/* Recv on an endpoint until the badges of all n signallers have been received through the bound
+ * notification */
+void fan_in_wait_fn(int argc, char **argv)
+{
+    assert(argc == N_FAN_IN_WAIT_ARGS);
+    seL4_CPtr ep = (seL4_CPtr) atol(argv[0]);
+    int n = atol(argv[1]);
+    volatile ccnt_t *end = (volatile ccnt_t *) atol(argv[2]);
+    seL4_CPtr done_ep = (seL4_CPtr) atol(argv[3]);
+
+    for (int i = 0; i < N_RUNS; i++) {
+        seL4_Word badges = 0;
+        while (badges != MASK(n)) {
+            seL4_Word badge;
+            seL4_Wait(ep, &badge);
+            badges |= badge;
+        }
+        SEL4BENCH_READ_CCNT(*end);
+    }
+
+    /* signal completion */
+    seL4_Send(done_ep, seL4_MessageInfo_new(0, 0, 0, 0));
+    /* block */
+    seL4_Wait(ep, NULL);
+}
+
 static void start_threads(helper_thread_t *first, helper_thread_t *second)
 {
     UNUSED int error;
@@ -156,7 +326,8 @@ static void stop_threads(helper_thread_t *first, helper_thread_t *second)
     assert(error == seL4_NoError);
 }
 
-static void benchmark(env_t *env, seL4_CPtr ep, seL4_CPtr ntfn, signal_results_t *results)
+static void benchmark(env_t *env, seL4_CPtr ep, seL4_CPtr ntfn, signal_results_t *results,
+                      benchmark_interference_t *interference)
 {
     helper_thread_t wait = {
         .argc = N_WAIT_ARGS,
@@ -178,14 +349,36 @@ static void benchmark(env_t *env, seL4_CPtr ep, seL4_CPtr ntfn, signal_results_t
     benchmark_configure_thread(env, ep, seL4_MaxPrio - 1, "signal", &signal.thread);
 
     sel4utils_create_word_args(wait.argv_strings, wait.argv, wait.argc, ntfn, ep, (seL4_Word) &end);
-    sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ntfn,
-                               (seL4_Word) &end, (seL4_Word) results->lo_prio_results, ep);
 
-    start_threads(&signal, &wait);
+    /* with CONFIG_COLD_CACHE, each benchmark is run again, polluting the caches before each signal */
+    void *cold_cache = benchmark_init_cold_cache(env);
+
+    for (int cache = CACHE_HOT; cache < N_CACHE_STATES; cache++) {
+        sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ntfn,
+                                   (seL4_Word) &end, (seL4_Word) results->lo_prio_results[cache], ep,
+                                   cache == CACHE_COLD ? (seL4_Word) cold_cache : 0);
+
+        start_threads(&signal, &wait);
+
+        benchmark_wait_children(ep, "children of notification benchmark", 2);
+
+        stop_threads(&signal, &wait);
+    }
+
+    /* with CONFIG_MEMORY_INTERFERENCE, run it again under each number of interferers */
+    for (int level = 0; config_set(CONFIG_MEMORY_INTERFERENCE) && level < N_INTERFERENCE_LEVELS; level++) {
+        benchmark_set_interference(interference, level);
+        sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ntfn,
+                                   (seL4_Word) &end, (seL4_Word) results->lo_prio_interference[level],
+                                   ep, 0);
 
-    benchmark_wait_children(ep, "children of notification benchmark", 2);
+        start_threads(&signal, &wait);
 
-    stop_threads(&signal, &wait);
+        benchmark_wait_children(ep, "children of notification benchmark", 2);
+
+        stop_threads(&signal, &wait);
+    }
+    benchmark_set_interference(interference, 0);
 
     seL4_CPtr auth = simple_get_tcb(&env->simple);
     /* now benchmark signalling to a lower prio thread */
@@ -201,14 +394,124 @@ static void benchmark(env_t *env, seL4_CPtr ep, seL4_CPtr ntfn, signal_results_t
     /* change params for high prio signaller */
     signal.fn = (sel4utils_thread_entry_fn) high_prio_signal_fn;
     signal.argc = N_HI_SIGNAL_ARGS;
-    sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ntfn,
-                               (seL4_Word) results, ep);
+
+    for (int cache = CACHE_HOT; cache < N_CACHE_STATES; cache++) {
+        sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ntfn,
+                                   (seL4_Word) results, (seL4_Word) results->hi_prio_results[cache], ep,
+                                   cache == CACHE_COLD ? (seL4_Word) cold_cache : 0);
+
+        start_threads(&wait, &signal);
+
+        benchmark_wait_children(ep, "children of notification", 1);
+
+        stop_threads(&wait, &signal);
+    }
+
+    for (int level = 0; config_set(CONFIG_MEMORY_INTERFERENCE) && level < N_INTERFERENCE_LEVELS; level++) {
+        benchmark_set_interference(interference, level);
+        sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ntfn,
+                                   (seL4_Word) results, (seL4_Word) results->hi_prio_interference[level],
+                                   ep, 0);
+
+        start_threads(&wait, &signal);
+
+        benchmark_wait_children(ep, "children of notification", 1);
+
+        stop_threads(&wait, &signal);
+    }
+    benchmark_set_interference(interference, 0);
+}
+
+/* benchmark the paths of a notification that is bound to a thread waiting in Recv on an endpoint */
+static void bound_benchmark(env_t *env, seL4_CPtr done_ep, seL4_CPtr park, signal_results_t *results)
+{
+    UNUSED int error;
+    vka_object_t ep, ntfn;
+    error = vka_alloc_endpoint(&env->slab_vka, &ep);
+    assert(error == seL4_NoError);
+    error = vka_alloc_notification(&env->slab_vka, &ntfn);
+    assert(error == seL4_NoError);
+
+    /* a cap for each signaller of the fan-in benchmark, each with its own badge bit */
+    static seL4_CPtr badged_ntfns[BIT(N_FAN_IN_LEVELS - 1)];
+    cspacepath_t ntfn_path;
+    vka_cspace_make_path(&env->slab_vka, ntfn.cptr, &ntfn_path);
+    for (int i = 0; i < ARRAY_SIZE(badged_ntfns); i++) {
+        cspacepath_t path;
+        error = vka_cspace_alloc_path(&env->slab_vka, &path);
+        assert(error == seL4_NoError);
+        error = vka_cnode_mint(&path, &ntfn_path, seL4_AllRights, BIT(i));
+        assert(error == seL4_NoError);
+        badged_ntfns[i] = path.capPtr;
+    }
+
+    helper_thread_t wait = {0}, signal = {0};
+    benchmark_configure_thread(env, done_ep, seL4_MaxPrio, "bound wait", &wait.thread);
+    benchmark_configure_thread(env, done_ep, seL4_MaxPrio - 1, "bound signal", &signal.thread);
+    error = seL4_TCB_BindNotification(wait.thread.tcb.cptr, ntfn.cptr);
+    assert(error == seL4_NoError);
+
+    /* signal to a higher prio thread in Recv */
+    ccnt_t end;
+    wait.fn = (sel4utils_thread_entry_fn) wait_fn;
+    wait.argc = N_WAIT_ARGS;
+    sel4utils_create_word_args(wait.argv_strings, wait.argv, wait.argc, ep.cptr, done_ep,
+                               (seL4_Word) &end);
+    signal.fn = (sel4utils_thread_entry_fn) bound_signal_fn;
+    signal.argc = N_BOUND_SIGNAL_ARGS;
+    sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ntfn.cptr,
+                               (seL4_Word) &end, (seL4_Word) results->bound_results, done_ep, park);
 
     start_threads(&wait, &signal);
+    benchmark_wait_children(done_ep, "children of bound notification benchmark", 2);
+    stop_threads(&wait, &signal);
+
+    /* the rest are between threads of the same prio */
+    seL4_CPtr auth = simple_get_tcb(&env->simple);
+    error = seL4_TCB_SetPriority(wait.thread.tcb.cptr, auth, seL4_MaxPrio - 1);
+    assert(error == seL4_NoError);
 
-    benchmark_wait_children(ep, "children of notification", 1);
+    /* Recv with a pending signal and a queued message */
+    wait.fn = (sel4utils_thread_entry_fn) pending_wait_fn;
+    wait.argc = N_PENDING_WAIT_ARGS;
+    sel4utils_create_word_args(wait.argv_strings, wait.argv, wait.argc, ep.cptr, ntfn.cptr,
+                               (seL4_Word) results, done_ep);
+    signal.fn = (sel4utils_thread_entry_fn) queued_send_fn;
+    signal.argc = N_QUEUED_SEND_ARGS;
+    sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc, ep.cptr, done_ep,
+                               park);
 
+    start_threads(&wait, &signal);
+    benchmark_wait_children(done_ep, "children of bound notification benchmark", 2);
     stop_threads(&wait, &signal);
+
+    /* badge fan-in */
+    wait.fn = (sel4utils_thread_entry_fn) fan_in_wait_fn;
+    wait.argc = N_FAN_IN_WAIT_ARGS;
+    signal.fn = (sel4utils_thread_entry_fn) fan_in_signal_fn;
+    signal.argc = N_FAN_IN_SIGNAL_ARGS;
+    for (int level = 0; level < N_FAN_IN_LEVELS; level++) {
+        sel4utils_create_word_args(wait.argv_strings, wait.argv, wait.argc, ep.cptr, BIT(level),
+                                   (seL4_Word) &end, done_ep);
+        sel4utils_create_word_args(signal.argv_strings, signal.argv, signal.argc,
+                                   (seL4_Word) badged_ntfns, BIT(level), (seL4_Word) &end,
+                                   (seL4_Word) results->fan_in_results[level], done_ep, park);
+
+        start_threads(&wait, &signal);
+        benchmark_wait_children(done_ep, "children of bound notification benchmark", 2);
+        stop_threads(&wait, &signal);
+    }
+}
+
+void measure_wait_overhead(seL4_CPtr ntfn, ccnt_t *results)
+{
+    ccnt_t start, end;
+    for (int i = 0; i < N_RUNS; i++) {
+        SEL4BENCH_READ_CCNT(start);
+        DO_NOP_WAIT(ntfn);
+        SEL4BENCH_READ_CCNT(end);
+        results[i] = (end - start);
+    }
 }
 
 void measure_signal_overhead(seL4_CPtr ntfn, ccnt_t *results)
@@ -229,15 +532,16 @@ int main(int argc, char **argv)
     vka_object_t done_ep, ntfn;
     signal_results_t *results;
 
-    /* configure the slab allocator - we need 2 tcbs, 2 scs, 1 ntfn, 1 ep */
+    /* configure the slab allocator - we need 4 tcbs, 4 scs, 2 ntfns, 2 eps, and the
+     * interferers */
     static size_t object_freq[seL4_ObjectTypeCount] = {
-        [seL4_TCBObject] = 2,
-        [seL4_EndpointObject] = 1,
+        [seL4_TCBObject] = 4 + N_INTERFERENCE_THREADS,
+        [seL4_EndpointObject] = 2,
 #ifdef CONFIG_KERNEL_RT
-        [seL4_SchedContextObject] = 2,
-        [seL4_ReplyObject] = 2,
+        [seL4_SchedContextObject] = 4 + N_INTERFERENCE_THREADS,
+        [seL4_ReplyObject] = 4 + N_INTERFERENCE_THREADS,
 #endif
-        [seL4_NotificationObject] = 1,
+        [seL4_NotificationObject] = 2,
     };
 
     env = benchmark_get_env(argc, argv, sizeof(signal_results_t), object_freq);
@@ -253,8 +557,13 @@ int main(int argc, char **argv)
 
     /* measure overhead */
     measure_signal_overhead(ntfn.cptr, results->overhead);
+    measure_wait_overhead(ntfn.cptr, results->wait_overhead);
+
+    benchmark_interference_t interference;
+    benchmark_init_interference(env, &interference);
 
-    benchmark(env, done_ep.cptr, ntfn.cptr, results);
+    benchmark(env, done_ep.cptr, ntfn.cptr, results, &interference);
+    bound_benchmark(env, done_ep.cptr, ntfn.cptr, results);
 
     /* done -> results are stored in shared memory so we can now return */
     benchmark_finished(EXIT_SUCCESS);
@@ -34,7 +34,7 @@ typedef struct _per_core_data {
 struct _pp_threads {
     vka_object_t ep;
     sel4utils_thread_t ping, pong;
-    sel4utils_checkpoint_t ping_cp, pong_cp;
+    benchmark_checkpoint_t ping_cp, pong_cp;
 
     /* arguments to pass to thread's main */
     char thread_args_strings[N_ARGS][WORD_STRING_SIZE];
@@ -112,29 +112,12 @@ void *pong_fn(int argc, char **argv, void *x)
 
 static inline void benchmark_multicore_reset_test(int nr_cores)
 {
-    int error;
     for (int i = 0; i < nr_cores; i++) {
-        seL4_TCB_Suspend(pp_threads[i].ping.tcb.cptr);
-        seL4_TCB_Suspend(pp_threads[i].pong.tcb.cptr);
+        /* restore ping and pong to start of benchmark, ping first so that it takes its sc back
+         * from pong before pong's own sc is rebound */
+        benchmark_restore_thread(&pp_threads[i].ping_cp, false);
+        benchmark_restore_thread(&pp_threads[i].pong_cp, false);
         pp_threads[i].pp_ipcs.calls_completed = 0;
-
-        /* rebind ping's sc */
-        if (config_set(CONFIG_KERNEL_RT)) {
-            error = api_sc_unbind(pp_threads[i].ping.sched_context.cptr);
-            ZF_LOGF_IF(error, "Failed to unbind pings sc");
-
-            error = api_sc_bind(pp_threads[i].ping.sched_context.cptr,
-                                pp_threads[i].ping.tcb.cptr);
-            ZF_LOGF_IF(error, "Failed to rebind pings sc");
-
-            /* give pong back it's sc */
-            error = api_sc_bind(pp_threads[i].pong.sched_context.cptr,
-                                pp_threads[i].pong.tcb.cptr);
-            ZF_LOGF_IF(error, "Failed to rebind pong's sc");
-        }
-        /* restore ping and pong to start of benchmark */
-        sel4utils_checkpoint_restore(&pp_threads[i].pong_cp, &pp_threads[i].pong, false);
-        sel4utils_checkpoint_restore(&pp_threads[i].ping_cp, &pp_threads[i].ping, false);
     }
 }
 
@@ -163,7 +146,13 @@ static void benchmark_multicore_ipc_throughput(env_t *env, smp_results_t *result
     int nr_cores = simple_get_core_count(&env->simple);
     int error;
 
+    const char *config = env->args->config;
+    size_t runs = runtime_config_runs(config, RUNS);
+
     for (int nr_test = 0; nr_test < TESTS; nr_test++) {
+        if (!runtime_config_param_enabled(config, nr_test)) {
+            continue;
+        }
         current_delay_cycle = smp_benchmark_params[nr_test].delay;
 
         for (int core_idx = 0; core_idx < nr_cores; core_idx++) {
@@ -176,14 +165,8 @@ static void benchmark_multicore_ipc_throughput(env_t *env, smp_results_t *result
                 ZF_LOGF_IF(error, "failed to unbind pong's sc");
             }
 
-            /* checkpoint pong */
-            sel4utils_checkpoint_thread(&pp_threads[core_idx].pong,
-                                        &pp_threads[core_idx].pong_cp, false);
-
-            /* checkpoint ping */
             seL4_TCB_Resume(pp_threads[core_idx].ping.tcb.cptr);
-            sel4utils_checkpoint_thread(&pp_threads[core_idx].ping, &pp_threads[core_idx].ping_cp, false);
-            for (int it = 0; it < RUNS; it++) {
+            for (int it = 0; it < runs; it++) {
                 results->benchmarks_result[nr_test][core_idx][it] =
                     benchmark_multicore_do_ping_pong(env, core_idx + 1);
             }
@@ -246,6 +229,10 @@ int main(int argc, char *argv[])
                                        (void *) N_ARGS, (void *) pp_threads[i].thread_argv, 0);
         assert(error == seL4_NoError);
 
+        /* checkpoint ping and pong, so they can be reset between tests */
+        benchmark_checkpoint_thread(&pp_threads[i].ping, &pp_threads[i].ping_cp);
+        benchmark_checkpoint_thread(&pp_threads[i].pong, &pp_threads[i].pong_cp);
+
         /* prepare thread for pp_ipcs on different cores */
         sched_params_t params = {0};
 #ifdef CONFIG_KERNEL_RT
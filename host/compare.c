@@ -0,0 +1,374 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+/*
+ * Compare the results of a sel4bench run against a baseline run.
+ *
+ * Rows are matched on the benchmark name and the values of every extra column (e.g "Function",
+ * "Direction", "IPC length"). The raw results of each pair of rows are compared with a Mann-Whitney
+ * U test, and a row is reported as a regression or an improvement when the difference is both
+ * significant and its median has moved by more than the threshold. Both runs must have been made
+ * with OutputRawResults; rows without raw results are skipped.
+ *
+ * Each compared row is reported with the shift in its median and the rank biserial correlation,
+ * the probability that a current sample is slower than a baseline sample minus the probability
+ * that it is faster.
+ *
+ * usage: compare [-a alpha] [-t threshold] [-q] baseline current
+ *
+ *   -a alpha      significance level of the test (default 0.01).
+ *   -t threshold  minimum shift in the median, in percent, to report (default 1.0).
+ *   -q            only report regressions, improvements and unmatched rows.
+ *
+ * Exits with 1 if there are any regressions, or any benchmarks failed in the current run, so it
+ * can be used to gate changes.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "math.h"
+#include "results_reader.h"
+
+typedef enum {
+    UNCHANGED,
+    REGRESSION,
+    IMPROVEMENT,
+    /* rows that could not be compared */
+    ONLY_BASELINE,
+    ONLY_CURRENT,
+    NO_RAW_RESULTS,
+    /* benchmarks that failed in the current run */
+    FAILED,
+    N_VERDICTS
+} verdict_t;
+
+static const char *const verdict_names[N_VERDICTS] = {
+    [UNCHANGED] = "unchanged",
+    [REGRESSION] = "REGRESSION",
+    [IMPROVEMENT] = "IMPROVEMENT",
+    [ONLY_BASELINE] = "only in baseline",
+    [ONLY_CURRENT] = "only in current",
+    [NO_RAW_RESULTS] = "no raw results",
+    [FAILED] = "FAILED",
+};
+
+static double alpha = 0.01;
+static double threshold = 1.0;
+static bool quiet = false;
+static size_t counts[N_VERDICTS];
+
+/* do rows a and b have the same extra columns, with the same values? */
+static bool
+rows_match(json_t *a, json_t *b)
+{
+    size_t n_columns = 0;
+    const char *key;
+    json_t *value;
+    json_object_foreach(a, key, value) {
+        if (is_result_key(key)) {
+            continue;
+        }
+        if (!json_equal(value, json_object_get(b, key))) {
+            return false;
+        }
+        n_columns++;
+    }
+
+    /* b must not have any columns that a does not */
+    json_object_foreach(b, key, value) {
+        n_columns -= !is_result_key(key);
+    }
+    return n_columns == 0;
+}
+
+/* print the benchmark name and extra columns that identify a row */
+static void
+print_row_name(const char *benchmark, json_t *row)
+{
+    printf("%s", benchmark);
+
+    bool first = true;
+    const char *key;
+    json_t *value;
+    json_object_foreach(row, key, value) {
+        if (is_result_key(key)) {
+            continue;
+        }
+        printf("%s%s=", first ? " [" : ", ", key);
+        first = false;
+        switch (json_typeof(value)) {
+        case JSON_STRING:
+            printf("%s", json_string_value(value));
+            break;
+        case JSON_INTEGER:
+            printf("%" JSON_INTEGER_FORMAT, json_integer_value(value));
+            break;
+        case JSON_REAL:
+            printf("%g", json_real_value(value));
+            break;
+        case JSON_TRUE:
+            printf("true");
+            break;
+        case JSON_FALSE:
+            printf("false");
+            break;
+        case JSON_NULL:
+            printf("null");
+            break;
+        default:
+            printf("?");
+            break;
+        }
+    }
+    if (!first) {
+        printf("]");
+    }
+}
+
+static void
+report(verdict_t verdict, const char *benchmark, json_t *row)
+{
+    counts[verdict]++;
+    if (quiet && verdict == UNCHANGED) {
+        return;
+    }
+    printf("%-16s ", verdict_names[verdict]);
+    print_row_name(benchmark, row);
+}
+
+static void
+compare_rows(const char *benchmark, const json_t *baseline, json_t *current)
+{
+    size_t n_baseline = 0, n_current = 0;
+    ccnt_t *baseline_samples = row_samples(baseline, &n_baseline);
+    ccnt_t *current_samples = row_samples(current, &n_current);
+
+    if (baseline_samples == NULL || current_samples == NULL || n_baseline == 0 || n_current == 0) {
+        report(NO_RAW_RESULTS, benchmark, current);
+        printf("\n");
+        free(baseline_samples);
+        free(current_samples);
+        return;
+    }
+
+    result_t before = calculate_results(n_baseline, baseline_samples);
+    result_t after = calculate_results(n_current, current_samples);
+    mann_whitney_t test = calculate_mann_whitney(n_baseline, baseline_samples, n_current,
+                                                 current_samples);
+    double shift = before.median == 0 ? (after.median == 0 ? 0 : INFINITY) :
+                   (after.median - before.median) / before.median * 100.0;
+
+    /* larger values are slower */
+    verdict_t verdict = UNCHANGED;
+    if (test.p < alpha && fabs(shift) >= threshold) {
+        verdict = shift > 0 ? REGRESSION : IMPROVEMENT;
+    }
+
+    report(verdict, benchmark, current);
+    if (!quiet || verdict != UNCHANGED) {
+        printf(": median %.1f -> %.1f (%+.2f%%), rank biserial %+.3f, p %.3g\n",
+               before.median, after.median, shift, test.rank_biserial, test.p);
+    }
+
+    free(baseline_samples);
+    free(current_samples);
+}
+
+static json_t *
+benchmark_rows(const json_t *benchmark)
+{
+    json_t *rows = json_object_get(benchmark, "Results");
+    return json_is_array(rows) ? rows : NULL;
+}
+
+/* name of a result set, or NULL if value is not one, e.g. the record of a failed benchmark */
+static const char *
+set_name(const json_t *value)
+{
+    const json_t *name = json_object_get(value, "Benchmark");
+    if (!json_is_string(name) || benchmark_rows(value) == NULL) {
+        return NULL;
+    }
+    return json_string_value(name);
+}
+
+/* number of result sets before index in root with the same name as the one at index */
+static size_t
+set_ordinal(const json_t *root, size_t index)
+{
+    const char *name = set_name(json_array_get(root, index));
+    size_t ordinal = 0;
+    for (size_t i = 0; i < index; i++) {
+        const char *other = set_name(json_array_get(root, i));
+        if (other != NULL && strcmp(other, name) == 0) {
+            ordinal++;
+        }
+    }
+    return ordinal;
+}
+
+/* find the result set with the same name and ordinal, as a benchmark can output several sets
+ * with the same name */
+static const json_t *
+find_benchmark(const json_t *root, const char *name, size_t ordinal)
+{
+    for (size_t i = 0; i < json_array_size(root); i++) {
+        const json_t *other = json_array_get(root, i);
+        if (set_name(other) != NULL && strcmp(set_name(other), name) == 0 && ordinal-- == 0) {
+            return other;
+        }
+    }
+    return NULL;
+}
+
+static void
+compare_benchmark(const char *name, const json_t *baseline, const json_t *current)
+{
+    json_t *baseline_rows = baseline != NULL ? benchmark_rows(baseline) : NULL;
+    json_t *current_rows = benchmark_rows(current);
+    if (current_rows == NULL) {
+        return;
+    }
+
+    /* each baseline row is matched at most once, so repeated rows are compared in order */
+    size_t n_baseline = json_array_size(baseline_rows);
+    bool *matched = checked_calloc(n_baseline, sizeof(bool));
+
+    size_t i;
+    json_t *row;
+    json_array_foreach(current_rows, i, row) {
+        if (!json_is_object(row)) {
+            continue;
+        }
+
+        json_t *match = NULL;
+        for (size_t j = 0; j < n_baseline && match == NULL; j++) {
+            json_t *baseline_row = json_array_get(baseline_rows, j);
+            if (!matched[j] && json_is_object(baseline_row) && rows_match(baseline_row, row)) {
+                matched[j] = true;
+                match = baseline_row;
+            }
+        }
+
+        if (match == NULL) {
+            report(ONLY_CURRENT, name, row);
+            printf("\n");
+        } else {
+            compare_rows(name, match, row);
+        }
+    }
+
+    for (size_t j = 0; j < n_baseline; j++) {
+        if (!matched[j]) {
+            report(ONLY_BASELINE, name, json_array_get(baseline_rows, j));
+            printf("\n");
+        }
+    }
+
+    free(matched);
+}
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-a alpha] [-t threshold] [-q] baseline current\n", name);
+    exit(2);
+}
+
+static json_t *
+open_results(const char *name)
+{
+    FILE *file = fopen(name, "r");
+    if (file == NULL) {
+        perror(name);
+        exit(2);
+    }
+    json_t *root = read_results(file, name);
+    fclose(file);
+    return root;
+}
+
+int
+main(int argc, char **argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "a:hqt:")) != -1) {
+        switch (opt) {
+        case 'a':
+            alpha = atof(optarg);
+            if (alpha <= 0 || alpha >= 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 't':
+            threshold = atof(optarg);
+            if (threshold < 0) {
+                usage(argv[0]);
+            }
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (argc - optind != 2) {
+        usage(argv[0]);
+    }
+
+    json_t *baseline = open_results(argv[optind]);
+    json_t *current = open_results(argv[optind + 1]);
+
+    size_t i;
+    json_t *benchmark;
+    json_array_foreach(current, i, benchmark) {
+        const char *name = json_string_value(json_object_get(benchmark, "Benchmark"));
+        const char *error = json_string_value(json_object_get(benchmark, "Error"));
+        if (name != NULL && error != NULL) {
+            counts[FAILED]++;
+            printf("%-16s %s: %s\n", verdict_names[FAILED], name, error);
+        } else if (set_name(benchmark) != NULL) {
+            compare_benchmark(name, find_benchmark(baseline, name, set_ordinal(current, i)),
+                              benchmark);
+        }
+    }
+
+    /* whole benchmarks that have gone */
+    json_array_foreach(baseline, i, benchmark) {
+        const char *name = set_name(benchmark);
+        if (name == NULL || find_benchmark(current, name, set_ordinal(baseline, i)) != NULL) {
+            continue;
+        }
+        size_t j;
+        json_t *row;
+        json_array_foreach(benchmark_rows(benchmark), j, row) {
+            report(ONLY_BASELINE, name, row);
+            printf("\n");
+        }
+    }
+
+    printf("\n%zu regressions, %zu improvements, %zu unchanged, %zu only in baseline, "
+           "%zu only in current, %zu without raw results, %zu failed benchmarks\n",
+           counts[REGRESSION], counts[IMPROVEMENT], counts[UNCHANGED], counts[ONLY_BASELINE],
+           counts[ONLY_CURRENT], counts[NO_RAW_RESULTS], counts[FAILED]);
+
+    json_decref(baseline);
+    json_decref(current);
+    return counts[REGRESSION] > 0 || counts[FAILED] > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
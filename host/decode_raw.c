@@ -0,0 +1,365 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+/*
+ * Convert sel4bench JSON output produced with EncodeRawResults back into the plain format.
+ *
+ * Every "Raw results" string is replaced with the array of integers it encodes, formatted the same
+ * way the driver would have formatted it, so the result is identical to the output of a run
+ * without EncodeRawResults. Everything else is copied through untouched.
+ *
+ * The input is either the JSON on its own, or a console log. In a console log, only the JSON
+ * between JSON OUTPUT and END JSON OUTPUT, and in each JSON CHUNK, is decoded, and the length and
+ * crc32 in the header of each chunk are updated to match its decoded JSON. Chunks that are
+ * truncated or corrupt are copied through as they are.
+ *
+ * usage: decode_raw [input [output]]
+ *
+ * Input and output default to stdin and stdout.
+ */
+/* for memmem() */
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raw_encoding.h"
+
+#define RAW_RESULTS_KEY "\"Raw results\""
+/* lines around the json in a console log */
+#define OUTPUT_START "JSON OUTPUT"
+#define OUTPUT_END "END JSON OUTPUT"
+#define CHUNK_START "JSON CHUNK "
+
+static const char *input_name = "<stdin>";
+
+static char *
+read_all(FILE *file, size_t *len)
+{
+    size_t size = 1 << 16;
+    char *buf = malloc(size);
+    *len = 0;
+
+    while (buf != NULL) {
+        *len += fread(&buf[*len], 1, size - *len, file);
+        if (*len < size) {
+            break;
+        }
+        size *= 2;
+        char *bigger = realloc(buf, size);
+        if (bigger == NULL) {
+            free(buf);
+        }
+        buf = bigger;
+    }
+
+    if (buf == NULL || ferror(file)) {
+        fprintf(stderr, "Failed to read %s\n", input_name);
+        exit(EXIT_FAILURE);
+    }
+    return buf;
+}
+
+/* same as the driver: a newline and depth * indent spaces, or a space between elements */
+static void
+write_indent(FILE *out, int indent, int depth, bool space)
+{
+    if (indent > 0) {
+        fprintf(out, "\n%*s", depth * indent, "");
+    } else if (space) {
+        fputc(' ', out);
+    }
+}
+
+static void
+write_samples(FILE *out, const char *encoded, size_t len, int indent, int depth)
+{
+    uint8_t *buf = malloc(len / 4 * 3 + 1);
+    if (buf == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long decoded = base64_decode(encoded, len, buf);
+    if (decoded < 0) {
+        fprintf(stderr, "Invalid base64 in raw results\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t buf_len = decoded;
+
+    fputc('[', out);
+    size_t total = 0;
+    for (size_t pos = 0; pos < buf_len;) {
+        uint64_t samples[RAW_ENCODING_FRAME_SAMPLES];
+        size_t n, consumed;
+        if (raw_decode_frame(&buf[pos], buf_len - pos, samples, &n, &consumed) != 0) {
+            fprintf(stderr, "Corrupt raw results frame at offset %zu\n", pos);
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < n; i++, total++) {
+            if (total > 0) {
+                fputc(',', out);
+            }
+            write_indent(out, indent, depth + 1, total > 0);
+            /* the driver writes samples as json integers, which are signed */
+            fprintf(out, "%" PRId64, (int64_t) samples[i]);
+        }
+        pos += consumed;
+    }
+    if (total > 0) {
+        write_indent(out, indent, depth, false);
+    }
+    fputc(']', out);
+
+    free(buf);
+}
+
+/* return the index just past the end of the string starting at start */
+static size_t
+skip_string(const char *buf, size_t len, size_t start)
+{
+    for (size_t i = start + 1; i < len; i++) {
+        if (buf[i] == '\\') {
+            i++;
+        } else if (buf[i] == '"') {
+            return i + 1;
+        }
+    }
+    fprintf(stderr, "Unterminated string in %s\n", input_name);
+    exit(EXIT_FAILURE);
+}
+
+/* decode a single top level array */
+static void
+decode_json(const char *buf, size_t len, FILE *out)
+{
+    /* the indent is whatever follows the opening of the array */
+    int indent = 0;
+    size_t start = 0;
+    while (start < len && isspace((unsigned char) buf[start])) {
+        start++;
+    }
+    if (start < len && buf[start] == '[') {
+        start++;
+        if (start < len && buf[start] == '\r') {
+            start++;
+        }
+        if (start < len && buf[start] == '\n') {
+            start++;
+            while (start + indent < len && buf[start + indent] == ' ') {
+                indent++;
+            }
+        }
+    }
+
+    int depth = 0;
+    size_t i = 0;
+    while (i < len) {
+        switch (buf[i]) {
+        case '[':
+        case '{':
+            depth++;
+            fputc(buf[i++], out);
+            break;
+        case ']':
+        case '}':
+            depth--;
+            fputc(buf[i++], out);
+            break;
+        case '"': {
+            size_t end = skip_string(buf, len, i);
+            fwrite(&buf[i], 1, end - i, out);
+            bool raw_results = end - i == strlen(RAW_RESULTS_KEY) &&
+                               strncmp(&buf[i], RAW_RESULTS_KEY, end - i) == 0;
+            i = end;
+            if (!raw_results) {
+                break;
+            }
+
+            /* copy the separator, then replace the value if it is an encoded string */
+            while (i < len && (buf[i] == ':' || buf[i] == ' ')) {
+                fputc(buf[i++], out);
+            }
+            if (i < len && buf[i] == '"') {
+                end = skip_string(buf, len, i);
+                write_samples(out, &buf[i + 1], end - i - 2, indent, depth);
+                i = end;
+            }
+            break;
+        }
+        default:
+            fputc(buf[i++], out);
+            break;
+        }
+    }
+}
+
+/* return the index of the start of the line after the one at pos */
+static size_t
+next_line(const char *buf, size_t len, size_t pos)
+{
+    const char *end = memchr(&buf[pos], '\n', len - pos);
+    return end != NULL ? (size_t)(end - buf) + 1 : len;
+}
+
+/* check whether the line at pos is exactly text, ignoring the line ending */
+static bool
+line_is(const char *buf, size_t len, size_t pos, const char *text)
+{
+    size_t text_len = strlen(text);
+    if (len - pos < text_len || strncmp(&buf[pos], text, text_len) != 0) {
+        return false;
+    }
+    pos += text_len;
+    if (pos < len && buf[pos] == '\r') {
+        pos++;
+    }
+    return pos == len || buf[pos] == '\n';
+}
+
+/* check whether the line at pos is the header of a chunk */
+static bool
+is_chunk(const char *buf, size_t len, size_t pos)
+{
+    return len - pos >= strlen(CHUNK_START) && strncmp(&buf[pos], CHUNK_START, strlen(CHUNK_START)) == 0;
+}
+
+/* find the first line at or after pos that is exactly text, or return len */
+static size_t
+find_line(const char *buf, size_t len, size_t pos, const char *text)
+{
+    while (pos < len && !line_is(buf, len, pos, text)) {
+        pos = next_line(buf, len, pos);
+    }
+    return pos;
+}
+
+/*
+ * Decode the chunk whose header line starts at pos, and write it out with a header for the
+ * decoded JSON. Returns the index just past the chunk's JSON, or just past its header if it is
+ * truncated or corrupt, in which case it is copied through as it is.
+ */
+static size_t
+decode_chunk(const char *buf, size_t len, size_t pos, FILE *out)
+{
+    size_t start = next_line(buf, len, pos);
+    char benchmark[64];
+    size_t size;
+    uint32_t crc;
+    if (sscanf(&buf[pos], CHUNK_START "%63s %zu %" SCNx32, benchmark, &size, &crc) != 3 ||
+        len - start < size || raw_encoding_crc32(0, (const uint8_t *) &buf[start], size) != crc) {
+        fprintf(stderr, "%s: copying truncated or corrupt chunk at offset %zu as it is\n",
+                input_name, pos);
+        fwrite(&buf[pos], 1, start - pos, out);
+        return start;
+    }
+
+    char *decoded;
+    size_t decoded_size;
+    FILE *chunk = open_memstream(&decoded, &decoded_size);
+    if (chunk == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    decode_json(&buf[start], size, chunk);
+    fclose(chunk);
+
+    /* keep the line ending of the original header */
+    const char *line_end = start - pos > 1 && buf[start - 2] == '\r' ? "\r\n" : "\n";
+    fprintf(out, CHUNK_START "%s %zu %08" PRIx32 "%s", benchmark, decoded_size,
+            raw_encoding_crc32(0, (const uint8_t *) decoded, decoded_size), line_end);
+    fwrite(decoded, 1, decoded_size, out);
+    free(decoded);
+    return start + size;
+}
+
+static void
+decode(const char *buf, size_t len, FILE *out)
+{
+    /* without any of the lines that surround it in a console log, the input is just the json */
+    bool console_log = find_line(buf, len, 0, OUTPUT_START) < len;
+    for (size_t pos = 0; pos < len && !console_log; pos = next_line(buf, len, pos)) {
+        console_log = is_chunk(buf, len, pos);
+    }
+    if (!console_log) {
+        decode_json(buf, len, out);
+        return;
+    }
+
+    /* copy the console log, decoding the json in it */
+    size_t pos = 0;
+    while (pos < len) {
+        if (is_chunk(buf, len, pos)) {
+            pos = decode_chunk(buf, len, pos, out);
+        } else if (line_is(buf, len, pos, OUTPUT_START)) {
+            size_t start = next_line(buf, len, pos);
+            /* the end line follows straight after the closing of the array */
+            const char *end_line = memmem(&buf[start], len - start, OUTPUT_END, strlen(OUTPUT_END));
+            size_t end = end_line != NULL ? (size_t)(end_line - buf) : len;
+            fwrite(&buf[pos], 1, start - pos, out);
+            decode_json(&buf[start], end - start, out);
+            pos = end;
+            if (pos < len) {
+                size_t next = next_line(buf, len, pos);
+                fwrite(&buf[pos], 1, next - pos, out);
+                pos = next;
+            }
+        } else {
+            size_t next = next_line(buf, len, pos);
+            fwrite(&buf[pos], 1, next - pos, out);
+            pos = next;
+        }
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    FILE *out = stdout;
+
+    if (argc > 3 || (argc > 1 && strcmp(argv[1], "-h") == 0)) {
+        fprintf(stderr, "usage: %s [input [output]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "-") != 0) {
+        input_name = argv[1];
+        in = fopen(argv[1], "r");
+        if (in == NULL) {
+            perror(argv[1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+        if (out == NULL) {
+            perror(argv[2]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    size_t len;
+    char *buf = read_all(in, &len);
+    decode(buf, len, out);
+    free(buf);
+
+    if (fclose(out) != 0) {
+        perror("Failed to write output");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
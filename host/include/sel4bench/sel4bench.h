@@ -0,0 +1,30 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+/* Host stand in for libsel4bench. Results are always processed as 64 bit values on the host. */
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint64_t ccnt_t;
+#define CCNT_FORMAT "%" PRIu64
+
+/*
+ * The generic events depend on the target's architecture, and the host tools never write averaged
+ * counter sets of their own: rows of counter results are read back with the names in their
+ * "Event" column. So there are none here.
+ */
+#define SEL4BENCH_NUM_GENERIC_EVENTS 0
+
+static __attribute__((unused)) const char *const *GENERIC_EVENT_NAMES = NULL;
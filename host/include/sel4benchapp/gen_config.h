@@ -0,0 +1,26 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+/*
+ * Host stand in for the driver's generated configuration. These are the settings the host tools
+ * process results with: those of the target build given with SEL4BENCH_TARGET_BUILD, so results
+ * are recalculated the same way as on the target, or otherwise the driver's defaults.
+ */
+
+#ifdef SEL4BENCH_TARGET_CONFIG
+#include SEL4BENCH_TARGET_CONFIG
+#else
+#define CONFIG_OUTPUT_RAW_RESULTS 1
+#define CONFIG_BOOTSTRAP_RESAMPLES 1000
+#define CONFIG_JSON_INDENT 0
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+/* Host stand in for the parts of libutils' config.h that the results processing code uses */
+
+/* evaluates to 1 if macro is defined to 1, and 0 otherwise */
+#define config_set(macro) _config_set(macro)
+#define _config_set(value) _config_set_(_config_macrotest_##value)
+#define _config_macrotest_1 ,
+#define _config_set_(comma) _config_set__(comma 1, 0)
+#define _config_set__(_, v, ...) v
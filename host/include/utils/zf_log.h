@@ -0,0 +1,54 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+/* Host stand in for the parts of libutils' zf_log.h that the results processing code uses */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ZF_LOG_VERBOSE 1
+#define ZF_LOG_DEBUG   2
+#define ZF_LOG_INFO    3
+#define ZF_LOG_WARN    4
+#define ZF_LOG_ERROR   5
+#define ZF_LOG_FATAL   6
+
+#ifndef ZF_LOG_LEVEL
+#define ZF_LOG_LEVEL ZF_LOG_WARN
+#endif
+
+#define ZF_LOG_PRINT(level, tag, ...) \
+    do { \
+        if ((level) >= ZF_LOG_LEVEL) { \
+            fprintf(stderr, tag ": " __VA_ARGS__); \
+            fputc('\n', stderr); \
+        } \
+    } while (0)
+
+#define ZF_LOGV(...) ZF_LOG_PRINT(ZF_LOG_VERBOSE, "verbose", __VA_ARGS__)
+#define ZF_LOGD(...) ZF_LOG_PRINT(ZF_LOG_DEBUG, "debug", __VA_ARGS__)
+#define ZF_LOGI(...) ZF_LOG_PRINT(ZF_LOG_INFO, "info", __VA_ARGS__)
+#define ZF_LOGW(...) ZF_LOG_PRINT(ZF_LOG_WARN, "warning", __VA_ARGS__)
+#define ZF_LOGE(...) ZF_LOG_PRINT(ZF_LOG_ERROR, "error", __VA_ARGS__)
+#define ZF_LOGF(...) \
+    do { \
+        ZF_LOG_PRINT(ZF_LOG_FATAL, "fatal", __VA_ARGS__); \
+        abort(); \
+    } while (0)
+
+#define ZF_LOGF_IF(cond, ...) \
+    do { \
+        if (cond) { \
+            ZF_LOGF(__VA_ARGS__); \
+        } \
+    } while (0)
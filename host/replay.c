@@ -0,0 +1,317 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+/*
+ * Recalculate the results in sel4bench JSON output on the host.
+ *
+ * The raw results of every row are run through the same processing code as the driver uses on
+ * the target, and the output is written in the same format. This allows changes to the processing
+ * to be checked and timed without rerunning the benchmarks on hardware.
+ *
+ * Only rows with raw results (plain or encoded) can be recalculated, so the input must come from
+ * a run with OutputRawResults. Rows without them are dropped with a warning. Results are
+ * converted to ns with the cycle counter frequency from the run's metadata, for the rows that
+ * were converted on the target.
+ *
+ * usage: replay [-i indent] [-r repeat] [-t] [input [output]]
+ *
+ *   -i indent  indent the output by this many spaces, 0 for a single line (default 2).
+ *   -r repeat  calculate the results of each row this many times, for timing (default 1).
+ *   -t         print how long processing each benchmark took to stderr.
+ *
+ * Input and output default to stdin and stdout.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "json.h"
+#include "math.h"
+#include "results_reader.h"
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* column types only distinguish bools, not true and false, and only real columns have nulls */
+static json_type
+column_type(const json_t *value)
+{
+    if (json_is_null(value)) {
+        return JSON_REAL;
+    }
+    return json_is_false(value) ? JSON_TRUE : json_typeof(value);
+}
+
+/* set up an extra column for every key in the first row that is not a result */
+static int
+init_columns(json_t *first, size_t n_rows, column_t *columns)
+{
+    int n_columns = 0;
+    const char *key;
+    json_t *value;
+
+    json_object_foreach(first, key, value) {
+        if (is_result_key(key)) {
+            continue;
+        }
+
+        column_t *column = &columns[n_columns];
+        column->header = (char *) key;
+        column->type = column_type(value);
+        switch (column->type) {
+        case JSON_STRING:
+            column->string_array = checked_calloc(n_rows, sizeof(char *));
+            break;
+        case JSON_INTEGER:
+            column->integer_array = checked_calloc(n_rows, sizeof(json_int_t));
+            break;
+        case JSON_REAL:
+            column->real_array = checked_calloc(n_rows, sizeof(double));
+            break;
+        case JSON_TRUE:
+            column->bool_array = checked_calloc(n_rows, sizeof(bool));
+            break;
+        default:
+            fprintf(stderr, "Column \"%s\" has an unsupported type, ignoring it\n", column->header);
+            continue;
+        }
+        n_columns++;
+    }
+
+    return n_columns;
+}
+
+/* copy the extra columns of row into index of each column. Returns false if they do not match. */
+static bool
+fill_columns(const json_t *row, size_t index, int n_columns, column_t *columns)
+{
+    for (int c = 0; c < n_columns; c++) {
+        const json_t *value = json_object_get(row, columns[c].header);
+        if (value == NULL || column_type(value) != columns[c].type) {
+            return false;
+        }
+    }
+
+    for (int c = 0; c < n_columns; c++) {
+        const json_t *value = json_object_get(row, columns[c].header);
+        switch (columns[c].type) {
+        case JSON_STRING:
+            columns[c].string_array[index] = (char *) json_string_value(value);
+            break;
+        case JSON_INTEGER:
+            columns[c].integer_array[index] = json_integer_value(value);
+            break;
+        case JSON_REAL:
+            columns[c].real_array[index] = json_is_null(value) ? NAN : json_real_value(value);
+            break;
+        default:
+            columns[c].bool_array[index] = json_is_true(value);
+            break;
+        }
+    }
+    return true;
+}
+
+/* write out the metadata of the run, returns false if element is not metadata */
+static bool
+replay_metadata(json_writer_t *writer, const json_t *element)
+{
+    const json_t *metadata = json_object_get(element, "Metadata");
+    if (!json_is_object(metadata)) {
+        return false;
+    }
+
+    const json_t *frequency = json_object_get(metadata, "Cycle counter frequency (Hz)");
+    if (!json_is_integer(frequency) || json_integer_value(frequency) <= 0) {
+        fprintf(stderr, "Skipping metadata without a cycle counter frequency\n");
+        return true;
+    }
+    json_write_metadata(writer, json_integer_value(frequency));
+    return true;
+}
+
+static void
+replay_benchmark(json_writer_t *writer, const json_t *benchmark, int repeat, bool timing)
+{
+    const json_t *name = json_object_get(benchmark, "Benchmark");
+    const json_t *rows = json_object_get(benchmark, "Results");
+    const json_t *error = json_object_get(benchmark, "Error");
+    if (json_is_string(name) && json_is_string(error)) {
+        /* a benchmark that failed on the target has nothing to replay */
+        const json_t *exit_code = json_object_get(benchmark, "Exit code");
+        json_write_error(writer, json_string_value(name), json_string_value(error),
+                         json_is_integer(exit_code) ? json_integer_value(exit_code) : 0);
+        return;
+    }
+    if (!json_is_string(name) || !json_is_array(rows)) {
+        fprintf(stderr, "Skipping element without a benchmark name and results\n");
+        return;
+    }
+
+    size_t n_rows = json_array_size(rows);
+    json_t *first = json_array_get(rows, 0);
+    result_set_t set = {
+        .name = json_string_value(name),
+        .results = checked_calloc(n_rows, sizeof(result_t)),
+        .extra_cols = NULL,
+    };
+    if (json_is_object(first)) {
+        set.extra_cols = checked_calloc(json_object_size(first), sizeof(column_t));
+        set.n_extra_cols = init_columns(first, n_rows, set.extra_cols);
+    }
+
+    double elapsed = 0;
+    size_t total_samples = 0;
+    for (size_t i = 0; i < n_rows; i++) {
+        const json_t *row = json_array_get(rows, i);
+        size_t n = 0;
+        ccnt_t *samples = json_is_object(row) ? row_samples(row, &n) : NULL;
+        if (samples == NULL) {
+            fprintf(stderr, "%s: dropping row %zu, it has no raw results\n", set.name, i);
+            continue;
+        }
+        if (!fill_columns(row, set.n_results, set.n_extra_cols, set.extra_cols)) {
+            fprintf(stderr, "%s: dropping row %zu, its columns do not match the first row\n",
+                    set.name, i);
+            free(samples);
+            continue;
+        }
+
+        double start = now();
+        result_t result = {0};
+        for (int r = 0; r < repeat; r++) {
+            result = calculate_results(n, samples);
+        }
+        elapsed += now() - start;
+        total_samples += n;
+
+        /* samples ignored on the target are not in the raw results, so keep the count */
+        const json_t *ignored = json_object_get(row, "Ignored");
+        if (json_is_integer(ignored)) {
+            result.ignored = json_integer_value(ignored);
+        }
+        /* only rows that were measured in cycles were converted to ns */
+        result.counts_events = json_object_get(row, "Min (ns)") == NULL;
+        set.results[set.n_results++] = result;
+    }
+
+    if (timing) {
+        fprintf(stderr, "%s: %d rows, %zu samples, %.6fs per repeat (%.1f ns/sample)\n",
+                set.name, set.n_results, total_samples, elapsed / repeat,
+                total_samples > 0 ? elapsed / repeat / total_samples * 1e9 : 0.0);
+    }
+
+    json_write_result_set(writer, set);
+
+    for (int i = 0; i < set.n_results; i++) {
+        free(set.results[i].raw_data);
+    }
+    for (int c = 0; c < set.n_extra_cols; c++) {
+        /* the union members all alias the same allocation */
+        free(set.extra_cols[c].string_array);
+    }
+    free(set.extra_cols);
+    free(set.results);
+}
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-i indent] [-r repeat] [-t] [input [output]]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    FILE *out = stdout;
+    const char *input_name = "<stdin>";
+    int indent = 2;
+    int repeat = 1;
+    bool timing = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hi:r:t")) != -1) {
+        switch (opt) {
+        case 'i':
+            indent = atoi(optarg);
+            if (indent < 0 || indent > 31) {
+                usage(argv[0]);
+            }
+            break;
+        case 'r':
+            repeat = atoi(optarg);
+            if (repeat < 1) {
+                usage(argv[0]);
+            }
+            break;
+        case 't':
+            timing = true;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (argc - optind > 2) {
+        usage(argv[0]);
+    }
+
+    if (optind < argc && strcmp(argv[optind], "-") != 0) {
+        input_name = argv[optind];
+        in = fopen(input_name, "r");
+        if (in == NULL) {
+            perror(input_name);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind + 1 < argc) {
+        out = fopen(argv[optind + 1], "w");
+        if (out == NULL) {
+            perror(argv[optind + 1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    json_t *root = read_results(in, input_name);
+
+    json_writer_t writer;
+    json_writer_start(&writer, out, JSON_INDENT(indent));
+    size_t i;
+    json_t *element;
+    json_array_foreach(root, i, element) {
+        if (!replay_metadata(&writer, element)) {
+            replay_benchmark(&writer, element, repeat, timing);
+        }
+    }
+    json_writer_finish(&writer);
+    fputc('\n', out);
+    json_decref(root);
+
+    if (fclose(out) != 0) {
+        perror("Failed to write output");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json.h"
+#include "raw_encoding.h"
+#include "results_reader.h"
+
+/* first line of each chunk written with FramedJsonOutput */
+#define CHUNK_START "JSON CHUNK "
+
+void *
+checked_calloc(size_t n, size_t size)
+{
+    void *ptr = calloc(n == 0 ? 1 : n, size);
+    if (ptr == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static char *
+read_all(FILE *file, const char *name, size_t *len)
+{
+    size_t size = 1 << 16;
+    char *buf = malloc(size);
+    *len = 0;
+
+    while (buf != NULL) {
+        *len += fread(&buf[*len], 1, size - *len, file);
+        if (*len < size) {
+            break;
+        }
+        size *= 2;
+        char *bigger = realloc(buf, size);
+        if (bigger == NULL) {
+            free(buf);
+        }
+        buf = bigger;
+    }
+
+    if (buf == NULL || ferror(file)) {
+        fprintf(stderr, "Failed to read %s\n", name);
+        exit(EXIT_FAILURE);
+    }
+    return buf;
+}
+
+/* return the start of the first line at or after pos that starts with prefix, or NULL */
+static const char *
+find_line(const char *buf, size_t len, size_t pos, const char *prefix)
+{
+    size_t prefix_len = strlen(prefix);
+    while (pos < len) {
+        if (len - pos >= prefix_len && strncmp(&buf[pos], prefix, prefix_len) == 0) {
+            return &buf[pos];
+        }
+        const char *end = memchr(&buf[pos], '\n', len - pos);
+        if (end == NULL) {
+            break;
+        }
+        pos = end - buf + 1;
+    }
+    return NULL;
+}
+
+/*
+ * Collect the benchmarks from each chunk in a console log of a run with FramedJsonOutput.
+ * Chunks that are truncated or corrupt are skipped with a warning, so the results of every
+ * benchmark that finished are recovered even if the run did not.
+ */
+static json_t *
+read_chunks(const char *buf, size_t len, const char *name)
+{
+    json_t *root = json_array();
+    if (root == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const char *chunk = find_line(buf, len, 0, CHUNK_START);
+    while (chunk != NULL) {
+        const char *header_end = memchr(chunk, '\n', buf + len - chunk);
+        size_t pos = header_end != NULL ? (size_t) (header_end - buf) + 1 : len;
+
+        char benchmark[64];
+        size_t size;
+        uint32_t crc;
+        if (header_end == NULL ||
+            sscanf(chunk, CHUNK_START "%63s %zu %" SCNx32, benchmark, &size, &crc) != 3) {
+            fprintf(stderr, "%s: skipping chunk with a bad header\n", name);
+        } else if (len - pos < size || raw_encoding_crc32(0, (const uint8_t *) &buf[pos], size) != crc) {
+            fprintf(stderr, "%s: skipping truncated or corrupt chunk for %s\n", name, benchmark);
+        } else {
+            json_error_t error;
+            json_t *results = json_loadb(&buf[pos], size, 0, &error);
+            if (!json_is_array(results)) {
+                fprintf(stderr, "%s: skipping chunk for %s: %s\n", name, benchmark,
+                        results == NULL ? error.text : "expected an array of benchmarks");
+            } else if (json_array_extend(root, results) != 0) {
+                fprintf(stderr, "Out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+            json_decref(results);
+            pos += size;
+        }
+
+        chunk = find_line(buf, len, pos, CHUNK_START);
+    }
+    return root;
+}
+
+json_t *
+read_results(FILE *file, const char *name)
+{
+    size_t len;
+    char *buf = read_all(file, name, &len);
+    json_error_t error;
+    json_t *root;
+    if (find_line(buf, len, 0, CHUNK_START) != NULL) {
+        root = read_chunks(buf, len, name);
+    } else {
+        root = json_loadb(buf, len, 0, &error);
+    }
+    free(buf);
+
+    if (root == NULL) {
+        fprintf(stderr, "%s:%d:%d: %s\n", name, error.line, error.column, error.text);
+        exit(EXIT_FAILURE);
+    }
+    if (!json_is_array(root)) {
+        fprintf(stderr, "%s: expected an array of benchmarks\n", name);
+        exit(EXIT_FAILURE);
+    }
+    return root;
+}
+
+bool
+is_result_key(const char *key)
+{
+    for (size_t i = 0; i < N_RESULT_KEYS; i++) {
+        if (strcmp(key, result_keys[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* decode a "Raw results" string, see raw_encoding.h. Returns NULL if it is corrupt. */
+static ccnt_t *
+decode_samples(const char *encoded, size_t *n)
+{
+    size_t len = strlen(encoded);
+    uint8_t *buf = checked_calloc(len / 4 * 3 + 1, 1);
+    long decoded = base64_decode(encoded, len, buf);
+    if (decoded < 0) {
+        free(buf);
+        return NULL;
+    }
+
+    size_t buf_len = decoded;
+    ccnt_t *samples = NULL;
+    size_t size = 0;
+    bool corrupt = false;
+
+    *n = 0;
+    for (size_t pos = 0; pos < buf_len;) {
+        uint64_t frame[RAW_ENCODING_FRAME_SAMPLES];
+        size_t n_frame, consumed;
+        if (raw_decode_frame(&buf[pos], buf_len - pos, frame, &n_frame, &consumed) != 0) {
+            corrupt = true;
+            break;
+        }
+        if (*n + n_frame > size) {
+            size = size == 0 ? RAW_ENCODING_FRAME_SAMPLES : size * 2;
+            ccnt_t *bigger = realloc(samples, size * sizeof(ccnt_t));
+            if (bigger == NULL) {
+                fprintf(stderr, "Out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+            samples = bigger;
+        }
+        for (size_t i = 0; i < n_frame; i++) {
+            samples[(*n)++] = frame[i];
+        }
+        pos += consumed;
+    }
+
+    free(buf);
+    if (corrupt) {
+        free(samples);
+        return NULL;
+    }
+    return samples != NULL ? samples : checked_calloc(1, sizeof(ccnt_t));
+}
+
+ccnt_t *
+row_samples(const json_t *row, size_t *n)
+{
+    const json_t *raw = json_object_get(row, "Raw results");
+    if (json_is_string(raw)) {
+        return decode_samples(json_string_value(raw), n);
+    }
+    if (!json_is_array(raw)) {
+        return NULL;
+    }
+
+    ccnt_t *samples = checked_calloc(json_array_size(raw), sizeof(ccnt_t));
+    for (size_t i = 0; i < json_array_size(raw); i++) {
+        const json_t *sample = json_array_get(raw, i);
+        if (!json_is_integer(sample)) {
+            free(samples);
+            return NULL;
+        }
+        samples[i] = json_integer_value(sample);
+    }
+    *n = json_array_size(raw);
+    return samples;
+}
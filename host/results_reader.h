@@ -0,0 +1,41 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+#pragma once
+
+/* Helpers for the host tools that read sel4bench JSON output */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <jansson.h>
+#include <sel4bench/sel4bench.h>
+
+/*
+ * Read and parse the whole of file. Exits with an error message naming name if it cannot be
+ * read or is not an array of benchmarks.
+ *
+ * The file can also be a console log of a run with FramedJsonOutput, in which case the
+ * benchmarks of every intact chunk are returned in a single array.
+ */
+json_t *read_results(FILE *file, const char *name);
+
+/* is key one of the result_keys written for every result, rather than an extra column? */
+bool is_result_key(const char *key);
+
+/*
+ * Return the raw results of a row, plain or encoded, in a buffer that the caller must free.
+ *
+ * @return the samples, or NULL if the row has none or they are corrupt.
+ */
+ccnt_t *row_samples(const json_t *row, size_t *n);
+
+/* allocate zeroed memory, or exit if there is none */
+void *checked_calloc(size_t n, size_t size);
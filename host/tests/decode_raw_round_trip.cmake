@@ -0,0 +1,43 @@
+#
+# Copyright 2019, Data61
+# Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+# ABN 41 687 119 230.
+#
+# This software may be distributed and modified according to the terms of
+# the BSD 2-Clause license. Note that NO WARRANTY is provided.
+# See "LICENSE_BSD2.txt" for details.
+#
+# @TAG(DATA61_BSD)
+#
+
+# Decode the log of make_test_log_encoded and compare it with the log of make_test_log, see
+# CMakeLists.txt.
+
+set(prefix "${CMAKE_CURRENT_BINARY_DIR}/decode_raw_indent_${INDENT}")
+
+foreach(tool MAKE_TEST_LOG MAKE_TEST_LOG_ENCODED)
+    execute_process(
+        COMMAND ${${tool}} ${INDENT}
+        OUTPUT_FILE "${prefix}_${tool}.log"
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${${tool}} failed: ${result}")
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND ${DECODE_RAW} "${prefix}_MAKE_TEST_LOG_ENCODED.log" "${prefix}_decoded.log"
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "decode_raw failed: ${result}")
+endif()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files "${prefix}_MAKE_TEST_LOG.log" "${prefix}_decoded.log"
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Decoded log ${prefix}_decoded.log differs from ${prefix}_MAKE_TEST_LOG.log")
+endif()
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+/*
+ * Write a console log like the driver's, with the same results as a framed chunk and in a
+ * JSON OUTPUT block, with text around both. Built with and without CONFIG_ENCODE_RAW_RESULTS, so
+ * that decoding the log of the encoded build can be checked against the log of the plain one.
+ *
+ * usage: make_test_log indent
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "json.h"
+#include "raw_encoding.h"
+
+/* more than a frame, so the encoded results span several frames */
+#define N_SAMPLES (RAW_ENCODING_FRAME_SAMPLES + 44)
+
+static void
+write_results(json_writer_t *writer)
+{
+    static ccnt_t samples[2][N_SAMPLES];
+    for (size_t i = 0; i < N_SAMPLES; i++) {
+        /* values that go both up and down, with a few that are large */
+        samples[0][i] = 400 + (i * 7919) % 97;
+        samples[1][i] = i % 50 == 0 ? UINT32_MAX - i : i;
+    }
+
+    result_t results[] = {
+        { .min = 400, .max = 496, .samples = N_SAMPLES, .raw_data = samples[0] },
+        { .min = 0, .max = UINT32_MAX, .samples = N_SAMPLES, .raw_data = samples[1] },
+        { .samples = 0, .raw_data = samples[0] },
+    };
+    char *names[] = {"first", "second", "empty"};
+    column_t column = {
+        .header = "Name",
+        .type = JSON_STRING,
+        .string_array = names,
+    };
+    result_set_t set = {
+        .name = "test",
+        .extra_cols = &column,
+        .n_extra_cols = 1,
+        .results = results,
+        .n_results = sizeof(results) / sizeof(results[0]),
+    };
+    json_write_result_set(writer, set);
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s indent\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t flags = JSON_PRESERVE_ORDER | JSON_INDENT(atoi(argv[1]));
+
+    printf("Booting all finished, dropped to user space\n\ntest Benchmarks\n==============\n\n");
+
+    char *buffer;
+    size_t size;
+    FILE *file = open_memstream(&buffer, &size);
+    json_writer_t writer;
+    json_writer_start(&writer, file, flags);
+    write_results(&writer);
+    json_writer_finish(&writer);
+    fclose(file);
+
+    printf("JSON CHUNK test %zu %08" PRIx32 "\n", size,
+           raw_encoding_crc32(0, (const uint8_t *) buffer, size));
+    fwrite(buffer, 1, size, stdout);
+    printf("\nEND JSON CHUNK\n");
+    free(buffer);
+
+    printf("JSON OUTPUT\n");
+    json_writer_start(&writer, stdout, flags);
+    write_results(&writer);
+    json_writer_finish(&writer);
+    printf("END JSON OUTPUT\n");
+
+    printf("All is well in the universe.\n\n\nFin\n");
+    return EXIT_SUCCESS;
+}
@@ -23,11 +23,10 @@
 #include <vka/vka.h>
 #include <vspace/vspace.h>
 #include <benchmark_types.h>
-
-/* average events = sel4bench generic events + the cycle counter */
-#define NUM_AVERAGE_EVENTS (SEL4BENCH_NUM_GENERIC_EVENTS + 1u)
-#define CYCLE_COUNT_EVENT SEL4BENCH_NUM_GENERIC_EVENTS
-#define AVERAGE_RUNS 10000
+#include <cold_cache.h>
+#include <interference.h>
+#include <result_ring.h>
+#include <sel4benchsupport/results.h>
 
 /* benchmarking environment set up by root task */
 typedef struct env {
@@ -59,6 +58,22 @@ typedef struct env {
     sel4rpc_client_t rpc_client;
 } env_t;
 
+/* a thread or process that can be reset without being restarted, see benchmark_checkpoint_thread */
+typedef struct benchmark_checkpoint {
+    /* the checkpointed thread */
+    sel4utils_thread_t *thread;
+    /* registers of the thread when it was checkpointed */
+    seL4_UserContext regs;
+} benchmark_checkpoint_t;
+
+/* memory interference threads, see benchmark_init_interference */
+typedef struct benchmark_interference {
+    /* the interference threads, at least one so this is never empty */
+    sel4utils_thread_t threads[MAX(N_INTERFERENCE_THREADS, 1)];
+    /* number of interference threads that are running */
+    int running;
+} benchmark_interference_t;
+
 /* initialise the benchmarking environment and return it */
 env_t *benchmark_get_env(int argc, char **argv, size_t results_size, size_t object_freq[seL4_ObjectTypeCount]);
 /* signal to the benchmark driver process that we are done */
@@ -127,6 +142,35 @@ void benchmark_configure_thread(env_t *env, seL4_CPtr fault_ep, uint8_t prio, ch
 int benchmark_spawn_process(sel4utils_process_t *process, vka_t *vka, vspace_t *vspace, int argc,
                             char *argv[], int resume);
 
+/*
+ * Checkpoint a configured thread, so that it can be reset with benchmark_restore_thread()
+ * instead of being restarted or recreated.
+ *
+ * Only the registers are saved, so a checkpoint is restored in the time it takes to write them
+ * back, but the thread's stack and memory are not. Checkpoint a thread after starting it
+ * suspended (with sel4utils_start_thread() or benchmark_spawn_process() and resume = 0) and
+ * before it first runs: restoring it then starts it again at its entry point with the same
+ * arguments. For a process, checkpoint process->thread.
+ *
+ * @param thread the thread to checkpoint, which must not be running
+ * @param[out] checkpoint the checkpoint
+ */
+void benchmark_checkpoint_thread(sel4utils_thread_t *thread, benchmark_checkpoint_t *checkpoint);
+
+/*
+ * Reset a thread to its checkpoint.
+ *
+ * The thread is suspended, which cancels any IPC it is blocked in, and its registers are
+ * restored. On MCS kernels the thread's scheduling context is taken back from any thread it was
+ * donated to and bound to the thread again, so a thread that was made passive is active once
+ * it is restored. A thread that a restored thread's scheduling context was donated to must be
+ * restored after it, e.g clients before their passive servers.
+ *
+ * @param checkpoint the checkpoint to restore
+ * @param resume resume the thread once it is restored
+ */
+void benchmark_restore_thread(benchmark_checkpoint_t *checkpoint, bool resume);
+
 /*
  * Wait for n child threads/processes to terminate successfully.
  *
@@ -143,16 +187,61 @@ int benchmark_spawn_process(sel4utils_process_t *process, vka_t *vka, vspace_t *
 void benchmark_wait_children(seL4_CPtr ep, char *name, int num_children);
 
 /*
- * Send the cycle counter result through given endpoint
+ * Create a result ring for a child process to send results back through, see result_ring.h.
  *
- * @param ep The endpoint the result will be send through
- * @param result The conteng to be sent
+ * The ring is mapped into the address space of process, and the child's handle is returned as
+ * RESULT_RING_NUM_ARGS words to pass as arguments, to be rebuilt with result_ring_from_args().
+ *
+ * @param env environment from benchmark_get_env
+ * @param process the process the ring is shared with
+ * @param num_pages the number of pages to use for the ring
+ * @param[out] ring the ring, as seen by the caller
+ * @param[out] args the ring, as seen by process
  */
-void send_result(seL4_CPtr ep, ccnt_t result);
+void benchmark_init_result_ring(env_t *env, sel4utils_process_t *process, size_t num_pages,
+                                result_ring_t *ring, seL4_Word args[RESULT_RING_NUM_ARGS]);
 
 /*
- * Receive the cycle counter result from given endpoint
+ * Allocate the buffer that benchmark_pollute_caches() sweeps for cold cache measurements.
+ *
+ * @param env environment from benchmark_get_env
+ * @return the buffer, or NULL without CONFIG_COLD_CACHE
+ */
+void *benchmark_init_cold_cache(env_t *env);
+
+/*
+ * Map the buffer from benchmark_init_cold_cache() into a shallow clone, so that it can pollute
+ * the caches itself.
+ *
+ * @param env environment from benchmark_get_env
+ * @param process the process to share the buffer with
+ * @param cold_cache the buffer
+ * @return the address of the buffer in process, or NULL without CONFIG_COLD_CACHE
+ */
+void *benchmark_share_cold_cache(env_t *env, sel4utils_process_t *process, void *cold_cache);
+
+/*
+ * Create the memory interference threads, see interference.h.
+ *
+ * N_INTERFERENCE_THREADS threads are created suspended, each with its own buffer, and pinned to
+ * the cores listed in the benchmark's "interference_cores" runtime setting (e.g "1,2,3"), in
+ * turn. By default they are spread over every core but core 0, where the benchmarks run. The
+ * threads use the current vspace, so this cannot be used by shallow clones.
+ *
+ * Does nothing without CONFIG_MEMORY_INTERFERENCE.
+ *
+ * @param env environment from benchmark_get_env
+ * @param[out] interference the interference threads
+ */
+void benchmark_init_interference(env_t *env, benchmark_interference_t *interference);
+
+/*
+ * Run the first n interference threads, and suspend the rest.
+ *
+ * Stop all interference (n = 0) before calling benchmark_finished(), as the threads are not on
+ * the benchmark's core and will not be stopped with it.
  *
- * @param ep The endpoint the result will be received from
+ * @param interference the interference threads from benchmark_init_interference
+ * @param n number of threads to run, at most N_INTERFERENCE_THREADS
  */
-ccnt_t get_result(seL4_CPtr ep);
+void benchmark_set_interference(benchmark_interference_t *interference, int n);
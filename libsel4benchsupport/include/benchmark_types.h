@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <sel4/types.h>
 #include <sel4platsupport/timer.h>
+#include <runtime_config.h>
 /* types shared between sel4bench and its child apps */
 
 #define SEL4BENCH_PROTOBUF_RPC (9000)
@@ -28,4 +29,6 @@ typedef struct {
     seL4_CPtr untyped_cptr;
     seL4_CPtr sched_ctrl;
     seL4_CPtr serial_ep;
+    /* settings from the runtime config file, see runtime_config.h */
+    char config[RUNTIME_CONFIG_SIZE];
 } benchmark_args_t;
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+#include <sel4benchsupport/gen_config.h>
+#include <utils/util.h>
+
+/*
+ * Cold cache measurements.
+ *
+ * With CONFIG_COLD_CACHE, benchmarks of kernel paths are measured once with hot caches, as
+ * usual, and once more with the caches (and with CONFIG_COLD_TLB, the TLB) evicted and the
+ * branch predictors polluted by benchmark_pollute_caches() right before each measurement. Raw
+ * results that are measured in both states have an extra dimension of N_CACHE_STATES.
+ */
+enum cache_state {
+    CACHE_HOT,
+    CACHE_COLD,
+};
+
+#ifdef CONFIG_COLD_CACHE
+#define N_CACHE_STATES 2
+#define COLD_CACHE_BYTES (CONFIG_COLD_CACHE_SIZE * 1024)
+#else
+#define N_CACHE_STATES 1
+#define COLD_CACHE_BYTES 0
+#endif
+
+#ifdef CONFIG_COLD_TLB
+#define COLD_TLB_PAGES CONFIG_COLD_TLB_PAGES
+#else
+#define COLD_TLB_PAGES 0
+#endif
+
+/* number of pages in the buffer used to evict the caches and TLB (needs sel4/sel4.h) */
+#define COLD_CACHE_PAGES MAX(BYTES_TO_SIZE_BITS_PAGES(COLD_CACHE_BYTES, seL4_PageBits), COLD_TLB_PAGES)
+
+/* name of a cache state, for the "Cache" column of results */
+static inline const char *cache_state_name(int state)
+{
+    return state == CACHE_COLD ? "Cold" : "Hot";
+}
+
+/* cache state of a run that is given cold_cache to pollute the caches with, or NULL */
+static inline int cache_state(const void *cold_cache)
+{
+    return cold_cache != NULL ? CACHE_COLD : CACHE_HOT;
+}
+
+/*
+ * Evict the caches and pollute the branch predictors, by sweeping a buffer the size of
+ * CONFIG_COLD_CACHE_SIZE and running a large block of code full of unpredictable branches. With
+ * CONFIG_COLD_TLB, a word of each of CONFIG_COLD_TLB_PAGES pages is touched as well.
+ *
+ * This only relies on the buffer and the text segment, so it can be called from shallow clones.
+ *
+ * @param cold_cache buffer from benchmark_init_cold_cache() or benchmark_share_cold_cache().
+ */
+void benchmark_pollute_caches(void *cold_cache);
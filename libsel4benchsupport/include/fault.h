@@ -12,6 +12,7 @@
 #pragma once
 
 #include <sel4bench/sel4bench.h>
+#include <cold_cache.h>
 
 #define N_IGNORED 10
 #define N_RUNS (100 + N_IGNORED)
@@ -23,8 +24,9 @@ typedef struct {
     /* we ignore the last result for the following,
      * but need to be able to write to the buffer without
      * overriding anything,
-     * so add 1 to the number recorded */
-    ccnt_t round_trip[N_RUNS + 1];
-    ccnt_t fault[N_RUNS + 1];
-    ccnt_t fault_reply[N_RUNS + 1];
+     * so add 1 to the number recorded.
+     * With CONFIG_COLD_CACHE, these are measured with hot and cold caches */
+    ccnt_t round_trip[N_CACHE_STATES][N_RUNS + 1];
+    ccnt_t fault[N_CACHE_STATES][N_RUNS + 1];
+    ccnt_t fault_reply[N_CACHE_STATES][N_RUNS + 1];
 } fault_results_t;
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+/*
+ * Constant size log-linear histogram, for recording far more samples than would fit in the
+ * results page as raw values.
+ *
+ * Values below HISTOGRAM_LINEAR_LIMIT are counted exactly. Above that, each power of 2 is split
+ * into HISTOGRAM_SUB_BUCKETS equal buckets, so a value is known to within 1/HISTOGRAM_SUB_BUCKETS
+ * of itself. The whole 64 bit range is covered.
+ *
+ * Benchmarks record into a histogram in their results page, and the driver extracts statistics
+ * from it. Recording only uses integer operations so it does not disturb the FPU state of the
+ * thread being measured.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1u << HISTOGRAM_SUB_BUCKET_BITS)
+/* values below this each get their own bucket */
+#define HISTOGRAM_LINEAR_LIMIT (2 * HISTOGRAM_SUB_BUCKETS)
+#define HISTOGRAM_BUCKETS (HISTOGRAM_LINEAR_LIMIT + \
+                           (64 - HISTOGRAM_SUB_BUCKET_BITS - 1) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct histogram {
+    /* total number of values recorded */
+    uint64_t count;
+    /* exact smallest and largest values recorded */
+    uint64_t min;
+    uint64_t max;
+    /* exact sum of all values recorded, for the mean */
+    uint64_t sum;
+    uint32_t counts[HISTOGRAM_BUCKETS];
+} histogram_t;
+
+static inline void
+histogram_init(histogram_t *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = UINT64_MAX;
+}
+
+static inline uint32_t
+histogram_bucket(uint64_t value)
+{
+    if (value < HISTOGRAM_LINEAR_LIMIT) {
+        return value;
+    }
+
+    /* keep the top HISTOGRAM_SUB_BUCKET_BITS bits below the most significant bit */
+    uint32_t msb = 63 - __builtin_clzll(value);
+    uint32_t shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+    uint32_t sub_bucket = (value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1);
+    return HISTOGRAM_LINEAR_LIMIT + (shift - 1) * HISTOGRAM_SUB_BUCKETS + sub_bucket;
+}
+
+/* smallest value that is counted in bucket */
+static inline uint64_t
+histogram_bucket_lowest(uint32_t bucket)
+{
+    if (bucket < HISTOGRAM_LINEAR_LIMIT) {
+        return bucket;
+    }
+
+    uint32_t shift = (bucket - HISTOGRAM_LINEAR_LIMIT) / HISTOGRAM_SUB_BUCKETS + 1;
+    uint64_t sub_bucket = (bucket - HISTOGRAM_LINEAR_LIMIT) % HISTOGRAM_SUB_BUCKETS;
+    return (HISTOGRAM_SUB_BUCKETS + sub_bucket) << shift;
+}
+
+/* largest value that is counted in bucket */
+static inline uint64_t
+histogram_bucket_highest(uint32_t bucket)
+{
+    if (bucket < HISTOGRAM_LINEAR_LIMIT) {
+        return bucket;
+    }
+
+    uint32_t shift = (bucket - HISTOGRAM_LINEAR_LIMIT) / HISTOGRAM_SUB_BUCKETS + 1;
+    return histogram_bucket_lowest(bucket) + ((UINT64_C(1) << shift) - 1);
+}
+
+static inline void
+histogram_record(histogram_t *histogram, uint64_t value)
+{
+    histogram->counts[histogram_bucket(value)]++;
+    histogram->count++;
+    histogram->sum += value;
+    if (value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+#include <sel4benchsupport/gen_config.h>
+#include <utils/util.h>
+
+/*
+ * Memory interference.
+ *
+ * With CONFIG_MEMORY_INTERFERENCE, benchmarks of kernel paths are measured again at each of
+ * N_INTERFERENCE_LEVELS levels of interference: level n has n threads on other cores streaming
+ * through (or chasing pointers through) buffers larger than the last level cache, competing with
+ * the benchmark for the shared caches and memory bandwidth. Raw results that are measured at
+ * each level have an extra dimension of N_INTERFERENCE_LEVELS, indexed by the number of
+ * interferers. Level 0 is measured in the same pass as the others, so that it is comparable.
+ */
+#ifdef CONFIG_MEMORY_INTERFERENCE
+#define N_INTERFERENCE_THREADS CONFIG_INTERFERENCE_THREADS
+#define INTERFERENCE_BUFFER_BYTES (CONFIG_INTERFERENCE_BUFFER_SIZE * 1024)
+#else
+#define N_INTERFERENCE_THREADS 0
+#define INTERFERENCE_BUFFER_BYTES 0
+#endif
+
+/* from no interferers to N_INTERFERENCE_THREADS */
+#define N_INTERFERENCE_LEVELS (N_INTERFERENCE_THREADS + 1)
+
+/* name of the access pattern of the interferers, for the results */
+static inline const char *interference_pattern_name(void)
+{
+    return config_set(CONFIG_INTERFERENCE_CHASE) ? "Pointer chase" : "Streaming copy";
+}
@@ -12,8 +12,13 @@
 #ifndef __SELBENCH_IPC_H
 #define __SELBENCH_IPC_H
 
+#include <autoconf.h>
+#include <sel4benchipc/gen_config.h>
 #include <sel4bench/sel4bench.h>
 #include <sel4utils/process.h>
+#include <sel4benchsupport/results.h>
+#include <cold_cache.h>
+#include <interference.h>
 
 #define OVERHEAD_BENCH_PARAMS(n) { .name = n }
 #define RUNS 16
@@ -25,6 +30,12 @@ enum overheads {
     RECV_OVERHEAD,
     CALL_10_OVERHEAD,
     REPLY_RECV_10_OVERHEAD,
+    NBSEND_OVERHEAD,
+    POLL_OVERHEAD,
+#ifdef CONFIG_KERNEL_RT
+    NBSEND_RECV_OVERHEAD,
+    NBSEND_WAIT_OVERHEAD,
+#endif
     /******/
     NUM_OVERHEAD_BENCHMARKS
 };
@@ -46,7 +57,30 @@ typedef enum {
     IPC_REPLYRECV_10_FUNC2 = 6,
     IPC_REPLYRECV_10_FUNC = 7,
     IPC_SEND_FUNC = 8,
-    IPC_RECV_FUNC = 9
+    IPC_RECV_FUNC = 9,
+    /* as the 10 word functions, but with the length of the benchmark's parameters */
+    IPC_CALL_N_FUNC = 10,
+    IPC_CALL_N_FUNC2 = 11,
+    IPC_REPLYRECV_N_FUNC2 = 12,
+    IPC_REPLYRECV_N_FUNC = 13,
+    /* Call with the benchmark's extra caps, which are all unwrapped, or the first transferred */
+    IPC_CALL_UNWRAP_FUNC2 = 14,
+    IPC_CALL_TRANSFER_FUNC2 = 15,
+    /* ReplyRecv with a receive slot, which is emptied between calls */
+    IPC_REPLYRECV_CAPS_FUNC2 = 16,
+    /* many clients calling one server */
+    IPC_CONTENTION_CLIENT_FUNC = 17,
+    IPC_CONTENTION_SERVER_FUNC = 18,
+    IPC_NBSEND_FUNC = 19,
+    /* Send to a server that polls for each message, and the server */
+    IPC_POLL_SEND_FUNC = 20,
+    IPC_POLL_FUNC = 21,
+    /* only with CONFIG_KERNEL_RT: ping pong with NBSendWait in the client and NBSendRecv in the
+     * server */
+    IPC_NBSENDWAIT_FUNC = 22,
+    IPC_NBSENDWAIT_FUNC2 = 23,
+    IPC_NBSENDRECV_FUNC2 = 24,
+    IPC_NBSENDRECV_FUNC = 25
 } helper_func_id_t;
 
 typedef seL4_Word (*helper_func_t)(int argc, char *argv[]);
@@ -68,8 +102,28 @@ typedef struct benchmark_params {
     enum overheads overhead_id;
     /* if CONFIG_KERNEL_RT, should the server be passive? */
     bool passive;
+    /* number of caps to send with the ipc */
+    uint8_t extra_caps;
+    /* is the first cap derived into the receiver's slot? The others are badged copies of the
+     * endpoint, which are unwrapped into their badges */
+    bool transfer_cap;
 } benchmark_params_t;
 
+/* Call slowpath with caps, same prio client to server, different address space */
+#define CAP_TRANSFER_PARAMS(caps, transfer) { \
+    .name         = "seL4_Call", \
+    .direction    = DIR_TO, \
+    .client_fn    = (transfer) ? IPC_CALL_TRANSFER_FUNC2 : IPC_CALL_UNWRAP_FUNC2, \
+    .server_fn    = IPC_REPLYRECV_CAPS_FUNC2, \
+    .same_vspace  = false, \
+    .client_prio  = seL4_MaxPrio - 1, \
+    .server_prio  = seL4_MaxPrio - 1, \
+    .length       = 0, \
+    .overhead_id  = CALL_OVERHEAD, \
+    .extra_caps   = caps, \
+    .transfer_cap = transfer \
+}
+
 struct overhead_benchmark_params {
     const char* name;
 };
@@ -164,9 +218,74 @@ static const benchmark_params_t benchmark_params[] = {
         .server_prio = seL4_MaxPrio - 1,
         .length = 10,
         .overhead_id = REPLY_RECV_10_OVERHEAD
-    }
+    },
+    /* Call with 1 to seL4_MsgMaxExtraCaps caps, all unwrapped */
+    CAP_TRANSFER_PARAMS(1, false),
+    CAP_TRANSFER_PARAMS(2, false),
+    CAP_TRANSFER_PARAMS(3, false),
+    /* Call with 1 to seL4_MsgMaxExtraCaps caps, the first transferred. There is only one receive
+     * slot, so the rest are unwrapped */
+    CAP_TRANSFER_PARAMS(1, true),
+    CAP_TRANSFER_PARAMS(2, true),
+    CAP_TRANSFER_PARAMS(3, true),
+    /* NBSend slowpath to a higher prio server, which is always waiting in Recv, different address
+     * space */
+    {
+        .name        = "seL4_NBSend",
+        .direction   = DIR_TO,
+        .client_fn   = IPC_NBSEND_FUNC,
+        .server_fn   = IPC_RECV_FUNC,
+        .same_vspace = false,
+        .client_prio = seL4_MaxPrio - 2,
+        .server_prio = seL4_MaxPrio - 1,
+        .length = 0,
+        .overhead_id = NBSEND_OVERHEAD
+    },
+    /* Poll of an endpoint that a higher prio client is queued on in Send, different address space.
+     * This is timed until the client runs again. */
+    {
+        .name        = "seL4_Poll",
+        .direction   = DIR_FROM,
+        .client_fn   = IPC_POLL_SEND_FUNC,
+        .server_fn   = IPC_POLL_FUNC,
+        .same_vspace = false,
+        .client_prio = seL4_MaxPrio - 1,
+        .server_prio = seL4_MaxPrio - 2,
+        .length = 0,
+        .overhead_id = POLL_OVERHEAD
+    },
+#ifdef CONFIG_KERNEL_RT
+    /* NBSendWait slowpath, same prio client to server, which waits in NBSendRecv, different
+     * address space */
+    {
+        .name        = "seL4_NBSendWait",
+        .direction   = DIR_TO,
+        .client_fn   = IPC_NBSENDWAIT_FUNC2,
+        .server_fn   = IPC_NBSENDRECV_FUNC2,
+        .same_vspace = false,
+        .client_prio = seL4_MaxPrio - 1,
+        .server_prio = seL4_MaxPrio - 1,
+        .length = 0,
+        .overhead_id = NBSEND_WAIT_OVERHEAD
+    },
+    /* NBSendRecv slowpath, same prio server to client, which waits in NBSendWait, different
+     * address space */
+    {
+        .name        = "seL4_NBSendRecv",
+        .direction   = DIR_FROM,
+        .client_fn   = IPC_NBSENDWAIT_FUNC,
+        .server_fn   = IPC_NBSENDRECV_FUNC,
+        .same_vspace = false,
+        .client_prio = seL4_MaxPrio - 1,
+        .server_prio = seL4_MaxPrio - 1,
+        .length = 0,
+        .overhead_id = NBSEND_RECV_OVERHEAD
+    },
+#endif /* CONFIG_KERNEL_RT */
 };
 
+compile_time_assert(cap_transfer_params_cover_extra_caps, seL4_MsgMaxExtraCaps == 3);
+
 static const struct overhead_benchmark_params overhead_benchmark_params[] = {
     [CALL_OVERHEAD]          = {"call"},
     [REPLY_RECV_OVERHEAD]    = {"reply recv"},
@@ -174,24 +293,93 @@ static const struct overhead_benchmark_params overhead_benchmark_params[] = {
     [RECV_OVERHEAD]          = {"recv"},
     [CALL_10_OVERHEAD]       = {"call"},
     [REPLY_RECV_10_OVERHEAD] = {"reply recv"},
+    [NBSEND_OVERHEAD]        = {"nbsend"},
+    [POLL_OVERHEAD]          = {"poll"},
+#ifdef CONFIG_KERNEL_RT
+    [NBSEND_RECV_OVERHEAD]   = {"nbsend recv"},
+    [NBSEND_WAIT_OVERHEAD]   = {"nbsend wait"},
+#endif
 };
 
-typedef struct ipc_results {
-    /* Raw results from benchmarking. These get checked for sanity */
-    ccnt_t overhead_benchmarks[NUM_OVERHEAD_BENCHMARKS][RUNS];
-    ccnt_t benchmarks[ARRAY_SIZE(benchmark_params)][RUNS];
-} ipc_results_t;
+/*
+ * With CONFIG_IPC_LENGTH_SWEEP, these are measured again for every message length from 0 to
+ * seL4_MsgMaxLength, which crosses from the message registers into the IPC buffer, and from the
+ * fastpath to the slowpath. The length is filled in for each run.
+ */
+#ifdef CONFIG_IPC_LENGTH_SWEEP
+#define N_SWEEP_LENGTHS (seL4_MsgMaxLength + 1)
+#else
+#define N_SWEEP_LENGTHS 1
+#endif
 
-static inline bool
-results_stable(ccnt_t *array, size_t size)
-{
-    for (size_t i = 1; i < size; i++) {
-        if (array[i] != array[i - 1]) {
-            return false;
-        }
+static const benchmark_params_t length_sweep_params[] = {
+    /* Call between client and server in different address spaces */
+    {
+        .name        = "seL4_Call",
+        .direction   = DIR_TO,
+        .client_fn   = IPC_CALL_N_FUNC2,
+        .server_fn   = IPC_REPLYRECV_N_FUNC2,
+        .same_vspace = false,
+        .client_prio = seL4_MaxPrio - 1,
+        .server_prio = seL4_MaxPrio - 1,
+        .overhead_id = CALL_10_OVERHEAD
+    },
+    /* ReplyRecv between server and client in different address spaces */
+    {
+        .name        = "seL4_ReplyRecv",
+        .direction   = DIR_FROM,
+        .client_fn   = IPC_CALL_N_FUNC,
+        .server_fn   = IPC_REPLYRECV_N_FUNC,
+        .same_vspace = false,
+        .client_prio = seL4_MaxPrio - 1,
+        .server_prio = seL4_MaxPrio - 1,
+        .overhead_id = REPLY_RECV_10_OVERHEAD
     }
+};
+
+/*
+ * With CONFIG_IPC_CONTENTION, 1, 2, 4 ... IPC_CONTENTION_MAX_CLIENTS clients call one server in
+ * another address space, which has a lower priority than all of them, so that their calls queue up
+ * on the endpoint. The clients are spread over IPC_CONTENTION_PRIOS priorities.
+ */
+#ifdef CONFIG_IPC_CONTENTION
+#define N_CONTENTION_LEVELS CONFIG_IPC_CONTENTION_LEVELS
+#else
+#define N_CONTENTION_LEVELS 1
+#endif
+#define IPC_CONTENTION_MAX_CLIENTS BIT(N_CONTENTION_LEVELS - 1)
+#define IPC_CONTENTION_PRIOS 4
+#define IPC_CONTENTION_SERVER_PRIO (seL4_MaxPrio - 1 - IPC_CONTENTION_PRIOS)
 
-    return true;
+/* priority of the client with index i */
+static inline uint8_t ipc_contention_client_prio(int i)
+{
+    return seL4_MaxPrio - 1 - i % IPC_CONTENTION_PRIOS;
 }
 
+/* with CONFIG_ALL_COUNTERS, every generic event is counted during each benchmark */
+#ifdef CONFIG_ALL_COUNTERS
+#define N_COUNTED_EVENTS SEL4BENCH_NUM_GENERIC_EVENTS
+#else
+#define N_COUNTED_EVENTS 1
+#endif
+
+typedef struct ipc_results {
+    /* Raw results from benchmarking. These get checked for sanity */
+    ccnt_t overhead_benchmarks[NUM_OVERHEAD_BENCHMARKS][RUNS];
+    /* with CONFIG_COLD_CACHE, each benchmark is measured with hot and cold caches */
+    ccnt_t benchmarks[N_CACHE_STATES][ARRAY_SIZE(benchmark_params)][RUNS];
+    /* generic events counted during each benchmark with hot caches, if CONFIG_ALL_COUNTERS */
+    ccnt_t benchmark_events[ARRAY_SIZE(benchmark_params)][N_COUNTED_EVENTS][RUNS];
+    /* with CONFIG_MEMORY_INTERFERENCE, each benchmark is measured with hot caches under each
+     * number of interferers */
+    ccnt_t interference[N_INTERFERENCE_LEVELS][ARRAY_SIZE(benchmark_params)][RUNS];
+    /* with CONFIG_IPC_LENGTH_SWEEP, each of the length sweep benchmarks at each length */
+    ccnt_t length_sweep[ARRAY_SIZE(length_sweep_params)][N_SWEEP_LENGTHS][RUNS];
+    /* with CONFIG_IPC_CONTENTION, for each number of clients, the time the server takes for each
+     * message, and the round trip time of a call in the middle of each client's calls */
+    ccnt_t contention_throughput[N_CONTENTION_LEVELS][RUNS];
+    ccnt_t contention_latency[N_CONTENTION_LEVELS][IPC_CONTENTION_MAX_CLIENTS][RUNS];
+} ipc_results_t;
+
 #endif /* __SELBENCH_IPC_H */
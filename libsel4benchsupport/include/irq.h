@@ -28,8 +28,13 @@ typedef struct irq_results {
 
 typedef struct irquser_results_t {
     ccnt_t overheads[N_RUNS];
-    ccnt_t thread_results[N_RUNS];
-    ccnt_t process_results[N_RUNS];
+    /* with CONFIG_COLD_CACHE, these are measured with hot and cold caches */
+    ccnt_t thread_results[N_CACHE_STATES][N_RUNS];
+    ccnt_t process_results[N_CACHE_STATES][N_RUNS];
+    /* with CONFIG_MEMORY_INTERFERENCE, these are measured with hot caches under each number of
+     * interferers */
+    ccnt_t thread_interference[N_INTERFERENCE_LEVELS][N_RUNS];
+    ccnt_t process_interference[N_INTERFERENCE_LEVELS][N_RUNS];
 } irquser_results_t;
 
 #endif /* __SELBENCH_IRQ_H */
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+/*
+ * Single producer, single consumer ring of results in memory shared between a benchmark and one
+ * of its child threads or processes.
+ *
+ * The producer (the child) pushes samples without any system calls until the ring fills up, at
+ * which point it rings the doorbell notification to wake the consumer (the benchmark) and blocks
+ * until there is space. Once it is done it flushes the ring, which also rings the doorbell. The
+ * consumer only blocks when the ring is empty.
+ *
+ * Samples can therefore be recorded inside the timed region and collected in bulk afterwards,
+ * without an IPC per sample.
+ *
+ * Everything here is static inline and only uses the handle, so it works in shallow cloned
+ * processes.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sel4/sel4.h>
+#include <sel4bench/sel4bench.h>
+
+/* keep the indices written by each side on separate cache lines */
+#define RESULT_RING_CACHE_LINE 64
+
+/* layout of the shared memory */
+typedef struct result_ring_shared {
+    /* number of samples pushed, only written by the producer */
+    volatile uint32_t head;
+    char head_padding[RESULT_RING_CACHE_LINE - sizeof(uint32_t)];
+    /* number of samples popped, only written by the consumer */
+    volatile uint32_t tail;
+    char tail_padding[RESULT_RING_CACHE_LINE - sizeof(uint32_t)];
+    /* set by the producer when it is about to block waiting for space */
+    volatile uint32_t producer_waiting;
+    /* number of slots, a power of 2 */
+    uint32_t size;
+    char padding[RESULT_RING_CACHE_LINE - 2 * sizeof(uint32_t)];
+    ccnt_t slots[];
+} result_ring_shared_t;
+
+/* one side's view of a ring, the addresses and caps are only valid for that side */
+typedef struct result_ring {
+    result_ring_shared_t *shared;
+    /* signalled by the producer to wake the consumer */
+    seL4_CPtr doorbell;
+    /* signalled by the consumer when it frees space for a blocked producer */
+    seL4_CPtr space;
+} result_ring_t;
+
+/* number of words needed to pass a ring handle to a child through its arguments */
+#define RESULT_RING_NUM_ARGS 3
+
+/* rebuild a ring handle from RESULT_RING_NUM_ARGS arguments, see benchmark_init_result_ring() */
+static inline result_ring_t
+result_ring_from_args(char *argv[])
+{
+    return (result_ring_t) {
+        .shared = (result_ring_shared_t *) strtoul(argv[0], NULL, 10),
+        .doorbell = (seL4_CPtr) strtoul(argv[1], NULL, 10),
+        .space = (seL4_CPtr) strtoul(argv[2], NULL, 10),
+    };
+}
+
+static inline bool
+result_ring_full(result_ring_shared_t *shared)
+{
+    return shared->head - __atomic_load_n(&shared->tail, __ATOMIC_SEQ_CST) == shared->size;
+}
+
+/* add a sample to the ring, blocking if it is full */
+static inline void
+result_ring_push(result_ring_t *ring, ccnt_t value)
+{
+    result_ring_shared_t *shared = ring->shared;
+
+    while (result_ring_full(shared)) {
+        /* the consumer checks producer_waiting after it updates tail, so either we see the
+         * space it made or it sees that we are waiting and signals us */
+        __atomic_store_n(&shared->producer_waiting, 1, __ATOMIC_SEQ_CST);
+        if (result_ring_full(shared)) {
+            seL4_Signal(ring->doorbell);
+            seL4_Wait(ring->space, NULL);
+        }
+    }
+
+    shared->slots[shared->head & (shared->size - 1)] = value;
+    __atomic_store_n(&shared->head, shared->head + 1, __ATOMIC_RELEASE);
+}
+
+/* wake the consumer to collect everything pushed so far */
+static inline void
+result_ring_flush(result_ring_t *ring)
+{
+    seL4_Signal(ring->doorbell);
+}
+
+/* remove the oldest sample from the ring, blocking until the producer flushes if it is empty */
+static inline ccnt_t
+result_ring_pop(result_ring_t *ring)
+{
+    result_ring_shared_t *shared = ring->shared;
+
+    /* signals can be left over from earlier flushes, so check again after every wake up */
+    while (__atomic_load_n(&shared->head, __ATOMIC_ACQUIRE) == shared->tail) {
+        seL4_Wait(ring->doorbell, NULL);
+    }
+
+    ccnt_t value = shared->slots[shared->tail & (shared->size - 1)];
+    __atomic_store_n(&shared->tail, shared->tail + 1, __ATOMIC_SEQ_CST);
+
+    if (__atomic_exchange_n(&shared->producer_waiting, 0, __ATOMIC_SEQ_CST)) {
+        seL4_Signal(ring->space);
+    }
+    return value;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Settings for a single benchmark, read from the runtime config file by the benchmark driver.
+ *
+ * The driver keeps the lines of the config file that are prefixed with the name of a benchmark,
+ * e.g "ipc.runs = 8", and passes them to the benchmark in benchmark_args_t with the prefix and
+ * any whitespace stripped: "runs=8\n". Settings are looked up with the functions below, which
+ * the benchmark and its process function in the driver must use in the same way.
+ *
+ * Settings understood by every benchmark that has a parameter table:
+ *  - runs:   number of runs to do, at most the number compiled in.
+ *  - params: comma separated list of indices or ranges of indices into the parameter table to
+ *            run, e.g "0,2-4". By default every entry is run.
+ *
+ * Settings understood by every benchmark that uses benchmark_init_interference():
+ *  - interference_cores: comma separated list of cores to run the memory interference threads
+ *            on in turn, e.g "2,3".
+ */
+#define RUNTIME_CONFIG_SIZE 2048
+
+/* name of the config file in the cpio archive */
+#define RUNTIME_CONFIG_FILE "sel4bench.conf"
+
+/* return the value of a setting, which is terminated by a newline, or NULL if it isn't set */
+static inline const char *runtime_config_get(const char *config, const char *key)
+{
+    size_t key_len = strlen(key);
+    for (const char *line = config; line != NULL && *line != '\0'; line = strchr(line, '\n')) {
+        if (*line == '\n') {
+            line++;
+        }
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == '=') {
+            return &line[key_len + 1];
+        }
+    }
+    return NULL;
+}
+
+/* return the integer value of a setting, or default_value if it isn't set or isn't an integer */
+static inline long runtime_config_int(const char *config, const char *key, long default_value)
+{
+    const char *value = runtime_config_get(config, key);
+    if (value == NULL) {
+        return default_value;
+    }
+
+    char *end;
+    long result = strtol(value, &end, 0);
+    if (end == value || (*end != '\n' && *end != '\0')) {
+        return default_value;
+    }
+    return result;
+}
+
+/* return the number of runs to do, which is at least 1 and at most max_runs */
+static inline size_t runtime_config_runs(const char *config, size_t max_runs)
+{
+    long runs = runtime_config_int(config, "runs", max_runs);
+    if (runs < 1 || (size_t) runs > max_runs) {
+        return max_runs;
+    }
+    return runs;
+}
+
+/* should the entry at index in the benchmark's parameter table be run? */
+static inline bool runtime_config_param_enabled(const char *config, size_t index)
+{
+    const char *value = runtime_config_get(config, "params");
+    if (value == NULL) {
+        return true;
+    }
+
+    while (*value != '\0' && *value != '\n') {
+        char *end;
+        unsigned long first = strtoul(value, &end, 0);
+        unsigned long last = first;
+        if (*end == '-') {
+            value = end + 1;
+            last = strtoul(value, &end, 0);
+        }
+        if (end == value) {
+            /* not a number, ignore the rest */
+            return false;
+        }
+        if (index >= first && index <= last) {
+            return true;
+        }
+        value = *end == ',' ? end + 1 : end;
+    }
+    return false;
+}
+
+/* return the number of entries of a parameter table of size n that should be run */
+static inline size_t runtime_config_num_params(const char *config, size_t n)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        count += runtime_config_param_enabled(config, i);
+    }
+    return count;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#pragma once
+
+/*
+ * Definitions shared between the benchmarks and the code that processes their results.
+ *
+ * This must not depend on anything more than libsel4bench's types, so that results can also be
+ * processed on the host.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sel4bench/sel4bench.h>
+
+/* average events = sel4bench generic events + the cycle counter */
+#define NUM_AVERAGE_EVENTS (SEL4BENCH_NUM_GENERIC_EVENTS + 1u)
+#define CYCLE_COUNT_EVENT SEL4BENCH_NUM_GENERIC_EVENTS
+#define AVERAGE_RUNS 10000
+
+static inline bool
+results_stable(ccnt_t *array, size_t size)
+{
+    for (size_t i = 1; i < size; i++) {
+        if (array[i] != array[i - 1]) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -14,15 +14,37 @@
 
 #include <sel4bench/sel4bench.h>
 #include <benchmark.h>
+#include <histogram.h>
 
 #define N_IGNORED 10
 #define N_RUNS (100 + N_IGNORED)
+/* number of runs recorded in the histogram, after N_IGNORED warm up runs */
+#define N_HISTOGRAM_RUNS 1000000
+/* badge fan-in is measured with 1, 2, 4 ... 2^(N_FAN_IN_LEVELS - 1) signallers, each with its own
+ * badge bit, which fit in the 28 bits of a badge on 32-bit platforms */
+#define N_FAN_IN_LEVELS 5
 
 typedef struct signal_results {
-    ccnt_t lo_prio_results[N_RUNS];
-    ccnt_t hi_prio_results[N_RUNS];
+    /* with CONFIG_COLD_CACHE, these are measured with hot and cold caches */
+    ccnt_t lo_prio_results[N_CACHE_STATES][N_RUNS];
+    ccnt_t hi_prio_results[N_CACHE_STATES][N_RUNS];
+    /* with CONFIG_MEMORY_INTERFERENCE, these are measured with hot caches under each number of
+     * interferers */
+    ccnt_t lo_prio_interference[N_INTERFERENCE_LEVELS][N_RUNS];
+    ccnt_t hi_prio_interference[N_INTERFERENCE_LEVELS][N_RUNS];
     ccnt_t overhead[N_RUNS];
     ccnt_t hi_prio_average[N_RUNS][NUM_AVERAGE_EVENTS];
+    histogram_t hi_prio_histogram;
+    /* with the notification bound to a thread that waits in Recv on an endpoint: a signal that
+     * wakes the thread, which has a higher prio, ... */
+    ccnt_t bound_results[N_RUNS];
+    /* ... a Recv that returns a pending signal, while a message is queued on the endpoint, and the
+     * Recv after it, which takes the message ... */
+    ccnt_t bound_pending_results[N_RUNS];
+    ccnt_t bound_queued_results[N_RUNS];
+    /* ... and the time for the thread to collect the badges of each number of signallers */
+    ccnt_t fan_in_results[N_FAN_IN_LEVELS][N_RUNS];
+    ccnt_t wait_overhead[N_RUNS];
 } signal_results_t;
 
 #endif /* __SELBENCH_SIGNAL_H */
@@ -44,6 +44,16 @@
     ); \
 } while(0)
 
+#define DO_NBSEND(ep, tag, swi) do { \
+    register seL4_Word dest asm("x0") = (seL4_Word)ep; \
+    register seL4_MessageInfo_t info asm("x1") = tag; \
+    register seL4_Word scno asm("x7") = seL4_SysNBSend; \
+    asm volatile(NOPS swi NOPS \
+        : "+r"(dest), "+r"(info) \
+        : "r"(scno) \
+    ); \
+} while(0)
+
 
 #ifdef CONFIG_KERNEL_RT
 #define DO_REPLY_RECV_10(ep, tag, ro, swi) do { \
@@ -79,6 +89,40 @@
         : "r"(scno), "r" (ro_copy) \
     ); \
 } while(0)
+
+#define DO_POLL(ep, swi) do { \
+    register seL4_Word src asm("x0") = (seL4_Word)ep; \
+    register seL4_MessageInfo_t info asm("x1"); \
+    register seL4_Word scno asm("x7") = seL4_SysNBWait; \
+    asm volatile(NOPS swi NOPS \
+        : "+r"(src), "=r"(info) \
+        : "r"(scno) \
+    ); \
+} while(0)
+
+/* these send to and receive on the same endpoint */
+#define DO_NBSEND_RECV(ep, tag, ro, swi) do { \
+    register seL4_Word src asm("x0") = (seL4_Word)ep; \
+    register seL4_MessageInfo_t info asm("x1") = tag; \
+    register seL4_Word scno asm("x7") = seL4_SysNBSendRecv; \
+    register seL4_Word ro_copy asm("x6") = ro; \
+    register seL4_Word dest asm("x8") = (seL4_Word)ep; \
+    asm volatile(NOPS swi NOPS \
+        : "+r"(src), "+r"(info) \
+        : "r"(scno), "r" (ro_copy), "r" (dest) \
+    ); \
+} while(0)
+
+#define DO_NBSEND_WAIT(ep, tag, swi) do { \
+    register seL4_Word src asm("x0") = (seL4_Word)ep; \
+    register seL4_MessageInfo_t info asm("x1") = tag; \
+    register seL4_Word scno asm("x7") = seL4_SysNBSendWait; \
+    register seL4_Word dest asm("x6") = (seL4_Word)ep; \
+    asm volatile(NOPS swi NOPS \
+        : "+r"(src), "+r"(info) \
+        : "r"(scno), "r" (dest) \
+    ); \
+} while(0)
 #else
 #define DO_REPLY_RECV_10(ep, tag, ro, swi) do { \
     register seL4_Word src asm("x0") = (seL4_Word)ep; \
@@ -110,6 +154,16 @@
         : "r"(scno) \
     ); \
 } while(0)
+
+#define DO_POLL(ep, swi) do { \
+    register seL4_Word src asm("x0") = (seL4_Word)ep; \
+    register seL4_MessageInfo_t info asm("x1"); \
+    register seL4_Word scno asm("x7") = seL4_SysNBRecv; \
+    asm volatile(NOPS swi NOPS \
+        : "+r"(src), "=r"(info) \
+        : "r"(scno) \
+    ); \
+} while(0)
 #endif /* CONFIG_KERNEL_RT */
 
 #define DO_REAL_CALL(ep, tag) DO_CALL(ep, tag, "svc #0")
@@ -125,3 +179,13 @@
 #define DO_NOP_REPLY_RECV_10(ep, tag, ro) DO_REPLY_RECV_10(ep, tag, ro, "nop")
 #define DO_REAL_RECV(ep, ro) DO_RECV(ep, ro, "svc #0")
 #define DO_NOP_RECV(ep, ro) DO_RECV(ep, ro, "nop")
+#define DO_REAL_NBSEND(ep, tag) DO_NBSEND(ep, tag, "svc #0")
+#define DO_NOP_NBSEND(ep, tag) DO_NBSEND(ep, tag, "nop")
+#define DO_REAL_POLL(ep) DO_POLL(ep, "svc #0")
+#define DO_NOP_POLL(ep) DO_POLL(ep, "nop")
+#ifdef CONFIG_KERNEL_RT
+#define DO_REAL_NBSEND_RECV(ep, tag, ro) DO_NBSEND_RECV(ep, tag, ro, "svc #0")
+#define DO_NOP_NBSEND_RECV(ep, tag, ro) DO_NBSEND_RECV(ep, tag, ro, "nop")
+#define DO_REAL_NBSEND_WAIT(ep, tag) DO_NBSEND_WAIT(ep, tag, "svc #0")
+#define DO_NOP_NBSEND_WAIT(ep, tag) DO_NBSEND_WAIT(ep, tag, "nop")
+#endif /* CONFIG_KERNEL_RT */
@@ -72,6 +72,25 @@
     ); \
 } while(0)
 
+#define DO_NBSEND(ep, tag, sys) do { \
+    uint32_t ep_copy = ep; \
+    uint32_t tag_copy = tag.words[0]; \
+    asm volatile( \
+        "movl %%esp, %%ecx \n"\
+        "leal 1f, %%edx \n"\
+        "1: \n" \
+        sys" \n" \
+        : \
+         "+S" (tag_copy), \
+         "+b" (ep_copy) \
+        : \
+         "a" (seL4_SysNBSend) \
+        : \
+         "ecx", \
+         "edx" \
+    ); \
+} while(0)
+
 #ifdef CONFIG_KERNEL_RT
 #define DO_REPLY_RECV(ep, tag, ro, sys) do { \
     uint32_t ep_copy = ep; \
@@ -139,6 +158,72 @@
          "esi" \
     ); \
 } while(0)
+
+#define DO_POLL(ep, sys) do { \
+    uint32_t ep_copy = ep; \
+    asm volatile( \
+        "movl %%esp, %%ecx \n"\
+        "leal 1f, %%edx \n"\
+        "1: \n" \
+        sys" \n" \
+        : \
+         "+b" (ep_copy) \
+        : \
+         "a" (seL4_SysNBWait) \
+        : \
+         "ecx", \
+         "edx", \
+         "esi" \
+    ); \
+} while(0)
+
+/* these send to and receive on the same endpoint. NBSendRecv has no register left for the endpoint
+ * to send to, so it goes in the IPC buffer, which the kernel reads it from */
+#define DO_NBSEND_RECV(ep, tag, ro, sys) do { \
+    uint32_t ep_copy = ep; \
+    uint32_t ro_copy = ro; \
+    seL4_GetIPCBuffer()->reserved = ep; \
+    asm volatile( \
+        "pushl %%ebp \n"\
+        "movl %%ecx, %%ebp \n"\
+        "movl %%esp, %%ecx \n"\
+        "leal 1f, %%edx \n"\
+        "1: \n" \
+        sys" \n" \
+        "popl %%ebp \n"\
+        : \
+         "+S" (tag), \
+         "+b" (ep_copy), \
+         "+c" (ro_copy) \
+        : \
+         "a" (seL4_SysNBSendRecv) \
+        : \
+         "edx", \
+         "memory" \
+    ); \
+} while(0)
+
+#define DO_NBSEND_WAIT(ep, tag, sys) do { \
+    uint32_t ep_copy = ep; \
+    uint32_t dest_copy = ep; \
+    asm volatile( \
+        "pushl %%ebp \n"\
+        "movl %%ecx, %%ebp \n"\
+        "movl %%esp, %%ecx \n"\
+        "leal 1f, %%edx \n"\
+        "1: \n" \
+        sys" \n" \
+        "popl %%ebp \n"\
+        : \
+         "+S" (tag), \
+         "+b" (ep_copy), \
+         "+c" (dest_copy) \
+        : \
+         "a" (seL4_SysNBSendWait) \
+        : \
+         "edx" \
+    ); \
+} while(0)
 #else
 #define DO_REPLY_RECV(ep, tag, ro, sys) do { \
     uint32_t ep_copy = ep; \
@@ -197,6 +282,24 @@
     ); \
 } while(0)
 
+#define DO_POLL(ep, sys) do { \
+    uint32_t ep_copy = ep; \
+    asm volatile( \
+        "movl %%esp, %%ecx \n"\
+        "leal 1f, %%edx \n"\
+        "1: \n" \
+        sys" \n" \
+        : \
+         "+b" (ep_copy) \
+        : \
+         "a" (seL4_SysNBRecv) \
+        : \
+         "ecx", \
+         "edx", \
+         "esi" \
+    ); \
+} while(0)
+
 #endif /* CONFIG_KERNEL_RT */
 
 #define READ_COUNTER_BEFORE SEL4BENCH_READ_CCNT
@@ -214,3 +317,13 @@
 #define DO_NOP_REPLY_RECV_10(ep, tag, ro) DO_REPLY_RECV_10(ep, tag, ro, ".byte 0x66\n.byte 0x90")
 #define DO_REAL_RECV(ep, ro) DO_RECV(ep, ro, "sysenter")
 #define DO_NOP_RECV(ep, ro) DO_RECV(ep, ro, ".byte 0x66\n.byte 0x90")
+#define DO_REAL_NBSEND(ep, tag) DO_NBSEND(ep, tag, "sysenter")
+#define DO_NOP_NBSEND(ep, tag) DO_NBSEND(ep, tag, ".byte 0x66\n.byte 0x90")
+#define DO_REAL_POLL(ep) DO_POLL(ep, "sysenter")
+#define DO_NOP_POLL(ep) DO_POLL(ep, ".byte 0x66\n.byte 0x90")
+#ifdef CONFIG_KERNEL_RT
+#define DO_REAL_NBSEND_RECV(ep, tag, ro) DO_NBSEND_RECV(ep, tag, ro, "sysenter")
+#define DO_NOP_NBSEND_RECV(ep, tag, ro) DO_NBSEND_RECV(ep, tag, ro, ".byte 0x66\n.byte 0x90")
+#define DO_REAL_NBSEND_WAIT(ep, tag) DO_NBSEND_WAIT(ep, tag, "sysenter")
+#define DO_NOP_NBSEND_WAIT(ep, tag) DO_NBSEND_WAIT(ep, tag, ".byte 0x66\n.byte 0x90")
+#endif /* CONFIG_KERNEL_RT */
@@ -64,6 +64,23 @@
             ); \
 } while (0)
 
+#define DO_NBSEND(ep, tag, sys) do { \
+    uint64_t ep_copy = ep; \
+    uint64_t tag_copy = tag.words[0]; \
+    asm volatile( \
+            "movq   %%rsp, %%rbx \n" \
+            sys "\n" \
+            "movq   %%rbx, %%rsp \n" \
+            : \
+            "+S" (tag_copy), \
+            "+D" (ep_copy) \
+            : \
+            "d" ((seL4_Word)seL4_SysNBSend) \
+            : \
+            "rcx", "rbx","r11" \
+            ); \
+} while (0)
+
 #ifdef CONFIG_KERNEL_RT
 #define DO_REPLY_RECV(ep, tag, ro, sys) do { \
     uint64_t ep_copy = ep; \
@@ -118,6 +135,61 @@
             :  "rcx", "rbx","r11" \
             ); \
 } while (0)
+
+#define DO_POLL(ep, sys) do { \
+    uint64_t ep_copy = ep; \
+    uint64_t tag = 0; \
+    asm volatile( \
+            "movq   %%rsp, %%rbx \n" \
+            sys" \n" \
+            "movq   %%rbx, %%rsp \n" \
+            : \
+            "+S" (tag) ,\
+            "+D" (ep_copy) \
+            : \
+            "d" ((seL4_Word)seL4_SysNBWait) \
+            :  "rcx", "rbx","r11" \
+            ); \
+} while (0)
+
+/* these send to and receive on the same endpoint */
+#define DO_NBSEND_RECV(ep, tag, ro, sys) do { \
+    uint64_t ep_copy = ep; \
+    register seL4_Word ro_copy asm("r12") = ro;\
+    register seL4_Word dest asm("r13") = ep;\
+    asm volatile( \
+            "movq   %%rsp, %%rbx \n" \
+            sys "\n" \
+            "movq  %%rbx, %%rsp \n" \
+            : \
+            "+S" (tag), \
+            "+D" (ep_copy) \
+            : \
+            "d"((seL4_Word)seL4_SysNBSendRecv), \
+            "r" (ro_copy), \
+            "r" (dest) \
+            : \
+            "rcx", "rbx","r11" \
+            ); \
+} while (0)
+
+#define DO_NBSEND_WAIT(ep, tag, sys) do { \
+    uint64_t ep_copy = ep; \
+    register seL4_Word dest asm("r12") = ep;\
+    asm volatile( \
+            "movq   %%rsp, %%rbx \n" \
+            sys "\n" \
+            "movq  %%rbx, %%rsp \n" \
+            : \
+            "+S" (tag), \
+            "+D" (ep_copy) \
+            : \
+            "d"((seL4_Word)seL4_SysNBSendWait), \
+            "r" (dest) \
+            : \
+            "rcx", "rbx","r11" \
+            ); \
+} while (0)
 #else
 #define DO_REPLY_RECV(ep, tag, ro, sys) do { \
     uint64_t ep_copy = ep; \
@@ -166,6 +238,22 @@
             :  "rcx", "rbx","r11" \
             ); \
 } while (0)
+
+#define DO_POLL(ep, sys) do { \
+    uint64_t ep_copy = ep; \
+    uint64_t tag = 0; \
+    asm volatile( \
+            "movq   %%rsp, %%rbx \n" \
+            sys" \n" \
+            "movq   %%rbx, %%rsp \n" \
+            : \
+            "+S" (tag) ,\
+            "+D" (ep_copy) \
+            : \
+            "d" ((seL4_Word)seL4_SysNBRecv) \
+            :  "rcx", "rbx","r11" \
+            ); \
+} while (0)
 #endif /* CONFIG_KERNEL_RT */
 
 #define READ_COUNTER_BEFORE(var) do { \
@@ -206,6 +294,16 @@
 #define DO_NOP_REPLY_RECV_10(ep, tag, ro) DO_REPLY_RECV_10(ep, tag, ro, ".byte 0x66\n.byte 0x90")
 #define DO_REAL_RECV(ep, ro) DO_RECV(ep, ro, "syscall")
 #define DO_NOP_RECV(ep, ro) DO_RECV(ep, ro, ".byte 0x66\n.byte 0x90")
+#define DO_REAL_NBSEND(ep, tag) DO_NBSEND(ep, tag, "syscall")
+#define DO_NOP_NBSEND(ep, tag) DO_NBSEND(ep, tag, ".byte 0x66\n.byte 0x90")
+#define DO_REAL_POLL(ep) DO_POLL(ep, "syscall")
+#define DO_NOP_POLL(ep) DO_POLL(ep, ".byte 0x66\n.byte 0x90")
+#ifdef CONFIG_KERNEL_RT
+#define DO_REAL_NBSEND_RECV(ep, tag, ro) DO_NBSEND_RECV(ep, tag, ro, "syscall")
+#define DO_NOP_NBSEND_RECV(ep, tag, ro) DO_NBSEND_RECV(ep, tag, ro, ".byte 0x66\n.byte 0x90")
+#define DO_REAL_NBSEND_WAIT(ep, tag) DO_NBSEND_WAIT(ep, tag, "syscall")
+#define DO_NOP_NBSEND_WAIT(ep, tag) DO_NBSEND_WAIT(ep, tag, ".byte 0x66\n.byte 0x90")
+#endif /* CONFIG_KERNEL_RT */
 
 #else
 #error Only support benchmarking with syscall as sysenter is known to be slower
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#include <autoconf.h>
+#include <sel4benchsupport/gen_config.h>
+
+#include <benchmark.h>
+#include <cold_cache.h>
+#include <utils/util.h>
+
+/* smallest cache line of the supported platforms, so that no line of the buffer is skipped */
+#define COLD_CACHE_LINE_SIZE 32
+
+/* kept at the start of the buffer, as shallow clones do not have a data segment */
+typedef struct cold_cache_state {
+    /* state of the pseudo random sequence that decides the branches */
+    seL4_Word seed;
+    /* result of the branches, so they are not optimised away */
+    seL4_Word sink;
+} cold_cache_state_t;
+
+/* a branch that is taken depending on the next number of a pseudo random sequence, which the
+ * branch predictors cannot learn. The fence keeps the compiler from replacing it with a
+ * conditional move. */
+#define BRANCH(n) \
+    x = x * 1103515245 + 12345; \
+    if (x & BIT(16)) { \
+        COMPILER_MEMORY_FENCE(); \
+        acc += (n); \
+    } else { \
+        acc ^= (n); \
+    }
+#define BRANCHES_4(n) BRANCH(n) BRANCH((n) + 1) BRANCH((n) + 2) BRANCH((n) + 3)
+#define BRANCHES_16(n) BRANCHES_4(n) BRANCHES_4((n) + 4) BRANCHES_4((n) + 8) BRANCHES_4((n) + 12)
+#define BRANCHES_64(n) BRANCHES_16(n) BRANCHES_16((n) + 16) BRANCHES_16((n) + 32) \
+    BRANCHES_16((n) + 48)
+#define BRANCHES_256(n) BRANCHES_64(n) BRANCHES_64((n) + 64) BRANCHES_64((n) + 128) \
+    BRANCHES_64((n) + 192)
+#define BRANCHES_1024(n) BRANCHES_256(n) BRANCHES_256((n) + 256) BRANCHES_256((n) + 512) \
+    BRANCHES_256((n) + 768)
+#define BRANCHES_2048(n) BRANCHES_1024(n) BRANCHES_1024((n) + 1024)
+
+/* enough code to evict the instruction cache (around 70KiB), with enough branches to evict the
+ * branch target buffer and scramble the branch history */
+static NO_INLINE void pollute_branches(cold_cache_state_t *state)
+{
+    seL4_Word x = state->seed;
+    seL4_Word acc = 0;
+
+#ifdef CONFIG_COLD_CACHE
+    /* this takes a while to compile, so only do it when it is used */
+    BRANCHES_2048(0)
+#endif
+
+    state->seed = x;
+    state->sink = acc;
+}
+
+void benchmark_pollute_caches(void *cold_cache)
+{
+    volatile char *buffer = cold_cache;
+
+    /* write to every line, so that dirty lines have to be written back to evict them */
+    for (size_t i = sizeof(cold_cache_state_t); i < COLD_CACHE_BYTES; i += COLD_CACHE_LINE_SIZE) {
+        buffer[i]++;
+    }
+
+    /* evict the TLB with a different line of each page, so this does not hit in the cache */
+    for (size_t i = 0; i < COLD_TLB_PAGES; i++) {
+        buffer[i * PAGE_SIZE_4K + (i * COLD_CACHE_LINE_SIZE) % PAGE_SIZE_4K]++;
+    }
+
+    pollute_branches(cold_cache);
+    COMPILER_MEMORY_FENCE();
+}
+
+void *benchmark_init_cold_cache(env_t *env)
+{
+    if (!config_set(CONFIG_COLD_CACHE)) {
+        return NULL;
+    }
+
+    void *cold_cache = vspace_new_pages(&env->vspace, seL4_AllRights, COLD_CACHE_PAGES,
+                                        seL4_PageBits);
+    ZF_LOGF_IF(cold_cache == NULL, "Failed to allocate cold cache buffer");
+    return cold_cache;
+}
+
+void *benchmark_share_cold_cache(env_t *env, sel4utils_process_t *process, void *cold_cache)
+{
+    if (!config_set(CONFIG_COLD_CACHE)) {
+        return NULL;
+    }
+
+    void *remote = vspace_share_mem(&env->vspace, &process->vspace, cold_cache, COLD_CACHE_PAGES,
+                                    seL4_PageBits, seL4_AllRights, 1);
+    ZF_LOGF_IF(remote == NULL, "Failed to share cold cache buffer");
+    return remote;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2019, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the BSD 2-Clause license. Note that NO WARRANTY is provided.
+ * See "LICENSE_BSD2.txt" for details.
+ *
+ * @TAG(DATA61_BSD)
+ */
+#include <autoconf.h>
+#include <sel4benchsupport/gen_config.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <utils/time.h>
+#include <utils/util.h>
+
+#include <benchmark.h>
+#include <interference.h>
+#include <runtime_config.h>
+
+/* largest cache line of the supported platforms, so that each step of a chase is a miss */
+#define INTERFERENCE_LINE_SIZE 64
+
+/* a line of a pointer chase buffer */
+typedef union chase_line {
+    struct {
+        /* index of the line that is read after this one, while the chase is set up */
+        seL4_Word successor;
+        /* the line that is read after this one */
+        union chase_line *next;
+    };
+    char bytes[INTERFERENCE_LINE_SIZE];
+} chase_line_t;
+
+static void stream_fn(char *buffer, UNUSED void *arg1, UNUSED void *ipc_buf)
+{
+    size_t half = INTERFERENCE_BUFFER_BYTES / 2;
+    while (true) {
+        memcpy(buffer + half, buffer, half);
+        COMPILER_MEMORY_FENCE();
+        memcpy(buffer, buffer + half, half);
+        COMPILER_MEMORY_FENCE();
+    }
+}
+
+static void chase_fn(chase_line_t *line, UNUSED void *arg1, UNUSED void *ipc_buf)
+{
+    while (true) {
+        line = *(chase_line_t *volatile *) &line->next;
+    }
+}
+
+/* link the lines of a buffer into a single cycle in a random order, so that the prefetchers
+ * cannot follow it */
+static void init_chase(chase_line_t *lines, size_t n, seL4_Word seed)
+{
+    for (size_t i = 0; i < n; i++) {
+        lines[i].successor = i;
+    }
+
+    /* Sattolo's algorithm, which only produces permutations that are a single cycle, so using
+     * the permutation as the successor of each line visits every line */
+    for (size_t i = n - 1; i > 0; i--) {
+        seed = seed * 1103515245 + 12345;
+        size_t j = (seed >> 16) % i;
+        seL4_Word tmp = lines[i].successor;
+        lines[i].successor = lines[j].successor;
+        lines[j].successor = tmp;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        lines[i].next = &lines[lines[i].successor];
+    }
+}
+
+/* core to run interference thread i on */
+static int interference_core(const char *config, int i, int nr_cores)
+{
+    const char *cores = runtime_config_get(config, "interference_cores");
+    if (cores == NULL) {
+        ZF_LOGF_IF(nr_cores < 2, "Memory interference needs more than one core");
+        return 1 + i % (nr_cores - 1);
+    }
+
+    /* count the listed cores, then pick the i-th in turn */
+    int n = 0;
+    long listed[CONFIG_MAX_NUM_NODES];
+    while (*cores != '\0' && *cores != '\n' && n < CONFIG_MAX_NUM_NODES) {
+        char *end;
+        listed[n] = strtol(cores, &end, 0);
+        if (end == cores) {
+            break;
+        }
+        n++;
+        cores = *end == ',' ? end + 1 : end;
+    }
+    ZF_LOGF_IF(n == 0, "No cores in interference_cores");
+
+    int core = listed[i % n];
+    ZF_LOGF_IF(core < 0 || core >= nr_cores, "Interference core %d does not exist", core);
+    return core;
+}
+
+void benchmark_init_interference(env_t *env, benchmark_interference_t *interference)
+{
+    interference->running = 0;
+    if (!config_set(CONFIG_MEMORY_INTERFERENCE)) {
+        return;
+    }
+
+    int nr_cores = simple_get_core_count(&env->simple);
+    for (int i = 0; i < N_INTERFERENCE_THREADS; i++) {
+        sel4utils_thread_t *thread = &interference->threads[i];
+        char *buffer = vspace_new_pages(&env->vspace, seL4_AllRights,
+                                        BYTES_TO_SIZE_BITS_PAGES(INTERFERENCE_BUFFER_BYTES, seL4_PageBits),
+                                        seL4_PageBits);
+        ZF_LOGF_IF(buffer == NULL, "Failed to allocate interference buffer");
+
+        sel4utils_thread_entry_fn fn = (sel4utils_thread_entry_fn) stream_fn;
+        if (config_set(CONFIG_INTERFERENCE_CHASE)) {
+            init_chase((chase_line_t *) buffer, INTERFERENCE_BUFFER_BYTES / sizeof(chase_line_t), i + 1);
+            fn = (sel4utils_thread_entry_fn) chase_fn;
+        } else {
+            /* fault the buffer in now, rather than while the first measurements are taken */
+            memset(buffer, 0, INTERFERENCE_BUFFER_BYTES);
+        }
+
+        char name[WORD_STRING_SIZE + 16];
+        snprintf(name, sizeof(name), "interference-%d", i);
+        benchmark_configure_thread(env, 0, seL4_MinPrio, name, thread);
+
+        int error = sel4utils_start_thread(thread, fn, buffer, NULL, 0);
+        ZF_LOGF_IF(error, "Failed to start %s", name);
+
+        /* pin it to its core, the same way as the smp benchmark */
+        int core = interference_core(env->args->config, i, nr_cores);
+        sched_params_t params = {0};
+#ifdef CONFIG_KERNEL_RT
+        params = sched_params_round_robin(params, &env->simple, core, CONFIG_BOOT_THREAD_TIME_SLICE * US_IN_MS);
+#else
+        params.core = core;
+#endif
+        error = sel4utils_set_sched_affinity(thread, params);
+        ZF_LOGF_IF(error, "Failed to move %s to core %d", name, core);
+    }
+}
+
+void benchmark_set_interference(benchmark_interference_t *interference, int n)
+{
+    ZF_LOGF_IF(n < 0 || n > N_INTERFERENCE_THREADS, "Invalid number of interferers %d", n);
+
+    for (int i = n; i < interference->running; i++) {
+        int error = seL4_TCB_Suspend(interference->threads[i].tcb.cptr);
+        ZF_LOGF_IFERR(error, "Failed to stop interference");
+    }
+    for (int i = interference->running; i < n; i++) {
+        int error = seL4_TCB_Resume(interference->threads[i].tcb.cptr);
+        ZF_LOGF_IFERR(error, "Failed to start interference");
+    }
+    interference->running = n;
+}
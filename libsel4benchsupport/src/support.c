@@ -256,6 +256,35 @@ void benchmark_wait_children(seL4_CPtr ep, char *name, int num_children)
     }
 }
 
+void benchmark_checkpoint_thread(sel4utils_thread_t *thread, benchmark_checkpoint_t *checkpoint)
+{
+    checkpoint->thread = thread;
+    int error = seL4_TCB_ReadRegisters(thread->tcb.cptr, false, 0,
+                                       sizeof(seL4_UserContext) / sizeof(seL4_Word), &checkpoint->regs);
+    ZF_LOGF_IFERR(error, "Failed to checkpoint thread");
+}
+
+void benchmark_restore_thread(benchmark_checkpoint_t *checkpoint, bool resume)
+{
+    sel4utils_thread_t *thread = checkpoint->thread;
+    int error = seL4_TCB_Suspend(thread->tcb.cptr);
+    ZF_LOGF_IFERR(error, "Failed to suspend thread");
+
+#ifdef CONFIG_KERNEL_RT
+    if (thread->sched_context.cptr != seL4_CapNull) {
+        /* take the sc back from the thread it was donated to, if any */
+        error = api_sc_unbind(thread->sched_context.cptr);
+        ZF_LOGF_IFERR(error, "Failed to unbind sc");
+        error = api_sc_bind(thread->sched_context.cptr, thread->tcb.cptr);
+        ZF_LOGF_IFERR(error, "Failed to rebind sc");
+    }
+#endif
+
+    error = seL4_TCB_WriteRegisters(thread->tcb.cptr, resume, 0,
+                                    sizeof(seL4_UserContext) / sizeof(seL4_Word), &checkpoint->regs);
+    ZF_LOGF_IFERR(error, "Failed to restore thread");
+}
+
 /*
  * We use sel4runtime to create the TLS for the thread as though it
  * were in our address space and then copy the contents into the
@@ -559,30 +588,41 @@ env_t *benchmark_get_env(int argc, char **argv, size_t results_size, size_t obje
     return &env;
 }
 
-void send_result(seL4_CPtr ep, ccnt_t result)
-{
-    int length = sizeof(ccnt_t) / sizeof(seL4_Word);
-    unsigned int shift = length > 1u ? seL4_WordBits : 0;
-    for (int i = length - 1; i >= 0; i--) {
-        seL4_SetMR(i, (seL4_Word) result);
-        result = result >> shift;
-    }
-
-    seL4_MessageInfo_t tag = seL4_MessageInfo_new(0, 0, 0, (seL4_Uint32)length);
-    seL4_Send(ep, tag);
-}
-
-ccnt_t get_result(seL4_CPtr ep)
+void benchmark_init_result_ring(env_t *env, sel4utils_process_t *process, size_t num_pages,
+                                result_ring_t *ring, seL4_Word args[RESULT_RING_NUM_ARGS])
 {
-    ccnt_t result = 0;
-    seL4_MessageInfo_t tag = api_wait(ep, NULL);
-    int length = seL4_MessageInfo_get_length(tag);
-    unsigned int shift = length > 1u ? seL4_WordBits : 0;
-
-    for (int i = 0; i < length; i++) {
-        result = result << shift;
-        result += seL4_GetMR(i);
+    vka_object_t doorbell, space;
+    cspacepath_t doorbell_path, space_path;
+
+    result_ring_shared_t *shared = vspace_new_pages(&env->vspace, seL4_AllRights, num_pages,
+                                                    seL4_PageBits);
+    ZF_LOGF_IF(shared == NULL, "Failed to allocate result ring");
+    void *remote = vspace_share_mem(&env->vspace, &process->vspace, shared, num_pages,
+                                    seL4_PageBits, seL4_AllRights, 1);
+    ZF_LOGF_IF(remote == NULL, "Failed to share result ring");
+
+    /* largest power of 2 number of slots that fits */
+    size_t num_slots = (num_pages * BIT(seL4_PageBits) - sizeof(*shared)) / sizeof(ccnt_t);
+    shared->size = 1;
+    while (shared->size * 2 <= num_slots) {
+        shared->size *= 2;
     }
+    shared->head = 0;
+    shared->tail = 0;
+    shared->producer_waiting = 0;
+
+    ZF_LOGF_IFERR(vka_alloc_notification(&env->slab_vka, &doorbell), "Failed to allocate doorbell");
+    ZF_LOGF_IFERR(vka_alloc_notification(&env->slab_vka, &space), "Failed to allocate ntfn");
+    vka_cspace_make_path(&env->slab_vka, doorbell.cptr, &doorbell_path);
+    vka_cspace_make_path(&env->slab_vka, space.cptr, &space_path);
+
+    *ring = (result_ring_t) {
+        .shared = shared,
+        .doorbell = doorbell.cptr,
+        .space = space.cptr,
+    };
 
-    return result;
+    args[0] = (seL4_Word) remote;
+    args[1] = sel4utils_copy_path_to_process(process, doorbell_path);
+    args[2] = sel4utils_copy_path_to_process(process, space_path);
 }